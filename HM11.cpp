@@ -24,10 +24,44 @@
 #include "HM11.h"
 
 /* ======================= Module constant declaration ====================== */
+#ifndef HM11_DEBUG  // -DHM11_DEBUG=0 -> no debug prints and no SoftwareSerial3 (e.g. extras/size.sh)
+  #ifdef __AVR__    // the debug port needs SoftwareSerial3
+    #define HM11_DEBUG  1
+  #else
+    #define HM11_DEBUG  0
+  #endif
+#endif
+#if HM11_DEBUG
 #define DEBUG_BLE                    //blup: define to activate the Serial Debug prints
+#endif
 #define DEBUG_BLE_PIN         14        // Arduino Pin
 #define DEBUG_BLE_BAUDRATE    115200    // in Baud
 
+/* AT verbs ("AT+<verb><argument>[?]") addressed by command_t -> same order as in HM11.h */
+static const char COMMAND_TABLE[][6] PROGMEM =
+{
+  "",     "ADDR", "ADTY", "ADVI", "BAUD", "CON",  "DELO",  "DISC",
+  "DISI", "IBE",  "IBEA", "IMME", "MARJ", "MINO", "MODE",  "MPIO",
+  "NAME", "PIO",  "POWE", "PWRM", "RENEW", "RESET", "ROLE", "SHOW",
+  "VERS", "SLEEP"
+};
+
+/* responses addressed by response_t -> same order as in HM11.h */
+static const char RESPONSE_TABLE[][9] PROGMEM =
+{
+  "OK", "OK+CONN", "OK+LOST", "OK+CONNF", "OK+CONNE", "OK+WAKE"
+};
+
+#if HM11_FEATURE_DETECTOR
+/* iBeacon scan (see startIBeaconScan) */
+static const char SCAN_PREFIX[] PROGMEM = "OK+DIS";
+#endif
+
+#ifdef HM11_RAM_PROFILING
+static const uint8_t RAM_CANARY = 0xC5;         // paint pattern of the free RAM
+static const uint8_t RAM_PROBE_MARGIN = 32;     // in bytes -> not painted below the probe (own stack frame)
+#endif
+
 /* ======================== Module macro declaration ======================== */
 #ifdef DEBUG_BLE
   #include <SoftwareSerial3.h>
@@ -41,7 +75,46 @@
   #define DebugBLE_println(...)
 #endif
 
+#ifdef HM11_RAM_PROFILING
+  #define HM11_RAM_PROBE(api)     RAMProbe ramProbe(this, api)
+#else
+  #define HM11_RAM_PROBE(api)
+#endif
+
 /* ====================== Module class instantiations ======================= */
+const HM11::retryPolicy_t HM11::DEFAULT_RETRY_POLICY = {2, 10, 100};   // 3 attempts, 10ms and 20ms backoff
+const HM11::retryPolicy_t HM11::NO_RETRY = {0, 0, 0};
+
+/* typical currents in uA (datasheet: active 8.5mA, sleep 0.4..1.5mA, the scan
+   keeps the receiver of the CC2541 on) -> measure your own modules */
+const HM11::currentProfile_t HM11::DEFAULT_CURRENT_PROFILE =
+{
+  {0, 8500, 8500, 15000, 9000, 8500, 600}   // disabled, idle, advertising, scanning, connected, resetting, sleeping
+};
+
+/* capabilities and timings per firmware ("AT+VERS?"), newest first -> the first
+   entry with version <= the detected one applies, an unknown firmware keeps the
+   worst case constants of the header file.
+   Only V540 has been measured: all entries keep its timings until the other
+   versions have been measured. The missing commands of the older versions are
+   taken from the version history of the datasheet and are not verified on a
+   module (a wrong bit fails the command with STATUS_UNSUPPORTED without sending
+   it). */
+#define HM11_CMD_BIT(cmd) (uint32_t(1) << HM11::cmd)
+const HM11::firmware_t HM11::FIRMWARE_TABLE[] PROGMEM =
+{
+  {539, 0,                                            100, 500, 1000},  // V539+: measured with V540
+  {517, HM11_CMD_BIT(CMD_DISI) | HM11_CMD_BIT(CMD_SHOW), 100, 500, 1000},  // iBeacon advertising, no iBeacon scan yet (datasheet)
+  {0,   HM11_CMD_BIT(CMD_DISI) | HM11_CMD_BIT(CMD_SHOW) | HM11_CMD_BIT(CMD_IBEA) | HM11_CMD_BIT(CMD_IBE) |
+        HM11_CMD_BIT(CMD_MARJ) | HM11_CMD_BIT(CMD_MINO), 100, 500, 1000}    // before iBeacon support (datasheet)
+};
+
+/* every command which setupAsIBeacon (and setIBeaconMode) sends */
+const uint32_t HM11::IBEACON_COMMANDS =
+  HM11_CMD_BIT(CMD_MARJ) | HM11_CMD_BIT(CMD_MINO) | HM11_CMD_BIT(CMD_IBE)  | HM11_CMD_BIT(CMD_NAME) |
+  HM11_CMD_BIT(CMD_ADVI) | HM11_CMD_BIT(CMD_POWE) | HM11_CMD_BIT(CMD_ADTY) | HM11_CMD_BIT(CMD_IBEA) |
+  HM11_CMD_BIT(CMD_DELO) | HM11_CMD_BIT(CMD_PWRM);
+#undef HM11_CMD_BIT
 
 /* ======================== Public member Functions ========================= */
 /** -------------------------------------------------------------------------
@@ -53,10 +126,18 @@
   --------------------------------------------------------------------------- */
   bool HM11::begin(uint32_t baudrate)
   {
+    HM11_RAM_PROBE(API_BEGIN);
     DebugBLE_begin(DEBUG_BLE_BAUDRATE);
     baudrate_ = baudrate_t(baudrate);
     enable();
-    return renewBLE();    // reset everything
+#if HM11_FEATURE_RENEW
+    bool successful = renewBLE();    // reset everything
+#else
+    invalidateShadow();
+    bool successful = setBaudrate();
+#endif
+    if (successful && firmwareVersion_ == 0) detectFirmware();
+    return successful;
   }
 
 /** -------------------------------------------------------------------------
@@ -97,6 +178,7 @@
     clearBit(*rxdPort_, rxd_);      // to prevent supply throug rxd
     clearBit(*txdPort_, txd_);      // to prevent supply throug txd
     setBit(*enPort_, enPin_);       // disable BLE
+    setModuleState(STATE_DISABLED);
   }
 
 /** -------------------------------------------------------------------------
@@ -110,28 +192,65 @@
     return !getBit(*enPort_, enPin_);
   }
 
+/** -------------------------------------------------------------------------
+  * \fn     setRetryPolicy
+  * \brief  sets the retry policy which is used for all AT commands
+  *
+  * \param  policy  retry policy (see struct in the header file)
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11::setRetryPolicy(const retryPolicy_t *policy)
+  {
+    retryPolicy_ = *policy;
+  }
+
 /** -------------------------------------------------------------------------
   * \fn     setTxPower
   * \brief  sets the transmission power
   *
   * \param  txPower  transmission power (see enumerator in the header file)
-  * \return None
+  * \return STATUS_OK if it succeeded
   --------------------------------------------------------------------------- */
-  void HM11::setTxPower(txPower_t txPower)
+  HM11::status_t HM11::setTxPower(txPower_t txPower)
   {
-    setConf("POWE" + String(txPower));
+    HM11_RAM_PROBE(API_SET_TX_POWER);
+    if (txPower > POWER_6DBM) return STATUS_INVALID;
+    if ((conf_.valid & CONF_TX_POWER) && conf_.txPower == txPower) return STATUS_OK;
+    status_t status = setConf(CMD_POWE, char('0' + txPower));
+    if (status == STATUS_OK)
+    {
+      conf_.txPower = txPower;
+      conf_.valid |= CONF_TX_POWER;
+    }
+    else conf_.valid &= ~CONF_TX_POWER;
+    return status;
   }
 
 /** -------------------------------------------------------------------------
   * \fn     getTxPower
   * \brief  gets the transmission power
   *
-  * \param  None
-  * \return transmission power (see enumerator in the header file)
+  * \param  txPower  gets the transmission power (see enumerator in the
+  *                  header file), unchanged on failure
+  * \return STATUS_OK if it succeeded
   --------------------------------------------------------------------------- */
-  HM11::txPower_t HM11::getTxPower()
+  HM11::status_t HM11::getTxPower(txPower_t &txPower)
   {
-    return txPower_t(getConf(F("POWE")).substring(7).toInt());  // "OK+Set:2"
+    HM11_RAM_PROBE(API_GET_TX_POWER);
+    if (!(conf_.valid & CONF_TX_POWER))
+    {
+      String response;
+      status_t status = getConf(CMD_POWE, response);  // "OK+Get:2"
+      if (status != STATUS_OK) return status;
+      /* one digit after the last ':' (the response may follow the rest of an older one) */
+      int colon = response.lastIndexOf(':');
+      char c = (colon >= 0 && unsigned(colon) + 2 == response.length()) ? response[colon + 1] : '\0';
+      if (c < '0' || c > char('0' + POWER_6DBM)) return STATUS_BAD_RESPONSE;  // do not shadow a failed read
+      conf_.txPower = txPower_t(c - '0');
+      conf_.valid |= CONF_TX_POWER;
+    }
+    txPower = conf_.txPower;
+    return STATUS_OK;
   }
 
 /** -------------------------------------------------------------------------
@@ -139,57 +258,57 @@
   * \brief  setup module as iBeacon with given data
   *
   * \param  iBeacon  iBeacon structure pointer (see struct in the header file)
-  * \return None
+  * \return STATUS_OK if it succeeded
   --------------------------------------------------------------------------- */
-  void HM11::setupAsIBeacon(iBeaconData_t *iBeacon)
+  HM11::status_t HM11::setupAsIBeacon(iBeaconData_t *iBeacon)
   {
+    HM11_RAM_PROBE(API_SETUP_AS_IBEACON);
     DebugBLE_println(F("setup as iBeacon"));
 
     /* control if given parameters are valid */
-    if ((iBeacon->name).length() > 12)  {DebugBLE_println(F("name ist too long!")); return;}
-    if ((iBeacon->uuid).length() != 32) {DebugBLE_println(F("UUID is invalid!")); return;}
-    if (iBeacon->major == 0 || iBeacon->major >= 0xFFFE) {DebugBLE_println(F("major have to be between 0 and 65'534!")); return;}
-    if (iBeacon->minor  == 0 || iBeacon->minor  >= 0xFFFE) {DebugBLE_println(F("minor have to be between 0 and 65'534!")); return;}
-    if (iBeacon->interv > INTERV_1285MS) {DebugBLE_println(F("unallowed interval!")); return;}
+    if ((iBeacon->name).length() > 12)  {DebugBLE_println(F("name ist too long!")); return STATUS_INVALID;}
+    if ((iBeacon->uuid).length() != 32) {DebugBLE_println(F("UUID is invalid!")); return STATUS_INVALID;}
+    if (iBeacon->major == 0 || iBeacon->major >= 0xFFFE) {DebugBLE_println(F("major have to be between 0 and 65'534!")); return STATUS_INVALID;}
+    if (iBeacon->minor  == 0 || iBeacon->minor  >= 0xFFFE) {DebugBLE_println(F("minor have to be between 0 and 65'534!")); return STATUS_INVALID;}
+    if (iBeacon->interv > INTERV_1285MS) {DebugBLE_println(F("unallowed interval!")); return STATUS_INVALID;}
+    /* fail before the first command instead of leaving a half configured module */
+    if (unsupported_ & IBEACON_COMMANDS) return STATUS_UNSUPPORTED;
 
-    /* convert given parameters to hex values */
-    String majorHex = byteToHexString(uint8_t((iBeacon->major & 0xFF00) >> 8)) + byteToHexString(uint8_t(iBeacon->major));
-    String minorHex  = byteToHexString(uint8_t((iBeacon->minor  & 0xFF00) >> 8)) + byteToHexString(uint8_t(iBeacon->minor));
+    char uuidPart[10];  // <n><8 hex digits>
 
     /* I-Beacon setup */
     #ifdef DEBUG_BLE
-      uint32_t t = millis();
+      uint32_t t = BLE_millis();
     #endif
+    /* stop at the first command which failed (after its retries) */
+    status_t status = STATUS_OK;
     //swResetBLE(); // not necessary
-    setConf("MARJ0x" + majorHex);
-    setConf("MINO0x" + minorHex);
-    setConf("IBE0" + iBeacon->uuid.substring(0, 8));
-    setConf("IBE1" + iBeacon->uuid.substring(8, 16));
-    setConf("IBE2" + iBeacon->uuid.substring(16, 24));
-    setConf("IBE3" + iBeacon->uuid.substring(24, 32));
-    setConf("NAME" + iBeacon->name);
-    setConf("ADVI" + String(iBeacon->interv));
-    setConf(F("ADTY3"));     // advertising type (3 = advertising only)
-    setConf(F("IBEA1"));     // enable iBeacon
-    setConf(F("DELO2"));     // iBeacon deploy mode (2 = broadcast only)
-    setConf(F("PWRM1"));     // auto sleep OFF
+    conf_.valid &= ~(CONF_MAJOR | CONF_MINOR | CONF_IBEACON);
+    if (status == STATUS_OK) status = setIBeaconId(CMD_MARJ, iBeacon->major);
+    if (status == STATUS_OK) status = setIBeaconId(CMD_MINO, iBeacon->minor);
+    for (uint8_t i = 0; (i < 4) && (status == STATUS_OK); i++)
+    {
+      uuidPart[0] = char('0' + i);
+      memcpy(&uuidPart[1], iBeacon->uuid.c_str() + 8 * i, 8);
+      uuidPart[9] = '\0';
+      status = setConf(CMD_IBE, uuidPart);
+    }
+    if (status == STATUS_OK) status = setConf(CMD_NAME, iBeacon->name.c_str());
+    if (status == STATUS_OK) status = setConf(CMD_ADVI, char('0' + iBeacon->interv));
+    if (status == STATUS_OK) status = setIBeaconMode();
     //setConf("PWRM0");        // auto sleep ON   //blup: this should be used -> to send new AT-commands implement wakeUpBLE
     //swResetBLE(); // not necessary
 
     #ifdef DEBUG_BLE
       /* show BLT address */
-      getConf(F("ADDR"));
+      String response;
+      getConf(CMD_ADDR, response);
     #endif
 
-    DebugBLE_print(F("dt setup BLE =\t")); DebugBLE_print(String(millis() - t)); DebugBLE_println(F("ms"));
+    DebugBLE_print(F("dt setup BLE =\t")); DebugBLE_print(String(BLE_millis() - t)); DebugBLE_println(F("ms"));
     DebugBLE_println("");
 
     // //Debug:
-    // sendDirectBLECommand("AT+HELP?", 2000);
-    // sendDirectBLECommand("AT+VERS", 2000);
-    // sendDirectBLECommand("AT+VER?", 2000);
-    // sendDirectBLECommand("AT+VERR?", 2000);
-    // sendDirectBLECommand("AT+VERS?", 2000);
     // getConf(F("MARJ"));
     // getConf(F("MINO"));
     // getConf(F("IBE0"));
@@ -202,20 +321,114 @@
     // getConf(F("IBEA"));     // enable iBeacon
     // getConf(F("DELO"));     // iBeacon deploy mode (2 = broadcast only)
     // getConf(F("PWRM"));     // auto sleep OFF
+
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setupAsIBeacon
+  * \brief  setup module as iBeacon with the given compile time profile
+  *
+  * \param  profile  iBeacon profile in PROGMEM (see HM11_IBEACON_PROFILE)
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setupAsIBeacon(const iBeaconProfile_t *profile)
+  {
+    HM11_RAM_PROBE(API_SETUP_AS_IBEACON);
+    DebugBLE_println(F("setup as iBeacon (profile)"));
+
+    /* the profile commands are streamed raw -> check every capability up front */
+    if (unsupported_ & IBEACON_COMMANDS) return STATUS_UNSUPPORTED;
+
+    /* the profile has been validated at compile time -> just stream the commands */
+    conf_.valid &= ~(CONF_MAJOR | CONF_MINOR | CONF_IBEACON);   // the first updateTelemetry() sends both
+    PGM_P cmds[] =
+    {
+      profile->marj, profile->mino,
+      profile->ibe[0], profile->ibe[1], profile->ibe[2], profile->ibe[3],
+      profile->name, profile->advi
+    };
+
+    #ifdef DEBUG_BLE
+      uint32_t t = BLE_millis();
+    #endif
+    status_t status = STATUS_OK;
+    for (uint8_t i = 0; (i < sizeof(cmds)/sizeof(PGM_P)) && (status == STATUS_OK); i++) status = setConf_P(cmds[i]);
+    if (status == STATUS_OK) status = setTxPower(txPower_t(pgm_read_byte(&profile->powe[7]) - '0'));  // "AT+POWE<n>", keeps the shadow up to date
+    if (status == STATUS_OK) status = setIBeaconMode();
+
+    DebugBLE_print(F("dt setup BLE =\t")); DebugBLE_print(String(BLE_millis() - t)); DebugBLE_println(F("ms"));
+    DebugBLE_println("");
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     updateTelemetry
+  * \brief  fast path to broadcast sensor readings in major and minor of a
+  *         running iBeacon (setupAsIBeacon), only changed values are sent and
+  *         the module keeps advertising
+  *
+  * \param  major  new major (e.g. humidity), 1..65'533
+  * \param  minor  new minor (e.g. temperature), 1..65'533
+  * \return STATUS_OK if it succeeded, STATUS_INVALID for an invalid value or
+  *         if the module is not set up as iBeacon, STATUS_BUSY while a
+  *         scan or a link is running
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::updateTelemetry(uint16_t major, uint16_t minor)
+  {
+    HM11_RAM_PROBE(API_UPDATE_TELEMETRY);
+    /* same limits as setupAsIBeacon */
+    if (major == 0 || major >= 0xFFFE || minor == 0 || minor >= 0xFFFE) return STATUS_INVALID;
+    if (!(conf_.valid & CONF_IBEACON)) return STATUS_INVALID;   // e.g. set up as detector
+    if (isScanning()) return STATUS_BUSY;
+#if HM11_FEATURE_CONNECTION
+    if (linkState_ != LINK_DISCONNECTED) return STATUS_BUSY;   // the AT commands would be sent to the peer as data
+#endif
+    bool sendMajor = !(conf_.valid & CONF_MAJOR) || conf_.major != major;
+    bool sendMinor = !(conf_.valid & CONF_MINOR) || conf_.minor != minor;
+    if (!sendMajor && !sendMinor) return STATUS_OK;
+
+    /* command acknowledge latency: call -> "OK+Set" of the last value (it
+       goes on air with the next advertising event, which is not measured) */
+    uint32_t ms = BLE_millis();
+    status_t status = STATUS_OK;
+    if (sendMajor) {status = setIBeaconId(CMD_MARJ, major); telemetryStats_.commands++;}
+    if (sendMinor && status == STATUS_OK) {status = setIBeaconId(CMD_MINO, minor); telemetryStats_.commands++;}
+    if (status != STATUS_OK) return status;
+
+    uint16_t latency = BLE_millis() - ms;
+    telemetryStats_.updates++;
+    telemetryStats_.lastAckLatency = latency;
+    telemetryStats_.ackLatencySum += latency;
+    if (latency > telemetryStats_.maxAckLatency) telemetryStats_.maxAckLatency = latency;
+    return STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getTelemetryStats
+  * \brief  returns the statistics of updateTelemetry()
+  *
+  * \return statistics (see struct in the header file)
+  --------------------------------------------------------------------------- */
+  const HM11::telemetryStats_t *HM11::getTelemetryStats()
+  {
+    return &telemetryStats_;
   }
 
+#if HM11_FEATURE_DETECTOR
 /** -------------------------------------------------------------------------
   * \fn     setupAsIBeaconDetector
   * \brief  setup module as iBeacon detector
+  *
+  * \return STATUS_OK if it succeeded
   --------------------------------------------------------------------------- */
-  void HM11::setupAsIBeaconDetector()
+  HM11::status_t HM11::setupAsIBeaconDetector()
   {
+    HM11_RAM_PROBE(API_SETUP_AS_DETECTOR);
     DebugBLE_println(F("setup as iBeacon detector"));
 
     /* iBeacon-Detector setup */
-    setConf(F("IMME1"));     // module work type (1 = responds only to AT-commands)
-    setConf(F("ROLE1"));     // module role (1 = central = master)
-    swResetBLE();
+    return setRole(true);
   }
 
 /** -------------------------------------------------------------------------
@@ -228,107 +441,9 @@
   --------------------------------------------------------------------------- */
   bool HM11::detectIBeacon(iBeaconData_t *iBeacon, uint16_t maxTimeToSearch)
   {
+    HM11_RAM_PROBE(API_DETECT_IBEACON);
     DebugBLE_println(F("detect iBeacons"));
-
-    bool match = false;
-
-    BLESerial_flush();
-
-    /* find near I-Beacons */
-    String response = getConf(F("DISI"));
-
-    /* if successful: continue reading to get the devices */
-    if (response.indexOf("OK+DISIS") >= 0)
-    {
-      DebugBLE_println(F("search for devices..."));
-      bool timeout = false;
-      uint32_t startMillis_BLE_total = millis();
-      String data = "";
-      iBeacon->accessAddress.reserve(8);
-      iBeacon->deviceAddress.reserve(12);
-      DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());
-      int16_t freeBytes = getFreeRAM() - MIN_RAM;
-      data.reserve(freeBytes);  // reserve other Strings before this one!
-      DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());
-      while(data.indexOf("OK+DISCE") < 0 && !timeout && freeBytes > 0)
-      {
-        if (BLESerial_available() > 0)
-        {
-          data.concat(String(char(BLESerial_read())));
-          freeBytes--;
-        }
-
-        if ((millis() - startMillis_BLE_total) >= maxTimeToSearch)
-        {
-          timeout = true;
-          DebugBLE_println(F("timeouted!"));
-        }
-      }
-      DebugBLE_print(F("dt data =\t")); DebugBLE_print((millis() - startMillis_BLE_total)); DebugBLE_println(F("ms"));
-      DebugBLE_print(F("data =\t\t")); DebugBLE_println(data);
-
-      /* HW reset to prevent the "AT+DISCE" */
-      if (timeout)
-      {
-        hwResetBLE();
-        while(BLESerial_available()) BLESerial_read();  //BLESerial_flush();
-      }
-
-      /* get total device count */
-      uint16_t j = 0;
-      byte deviceCounter;
-      for(deviceCounter = 0; data.indexOf("OK+DISC:", j) >= 0; deviceCounter++)
-      {
-        j = data.indexOf("OK+DISC:", j) + DEFAULT_RESPONSE_LENGTH;
-      }
-      DebugBLE_print(deviceCounter); DebugBLE_println(F(" device(s) found"));
-
-      // /* convert given uuid to hex */
-      // String uuidHex = "";
-      // uuidHex.reserve(32);
-      // DebugBLE_print(F("iBeacon->uuid = ")); DebugBLE_println(iBeacon->uuid);
-      // for (uint8_t n = 0; n < 16; n++)
-      // {
-      //   uuidHex.concat(byteToHexString(uint8_t((iBeacon->uuid)[n] - '0')));
-      // }
-      // DebugBLE_print("uuidHex = "); DebugBLE_println(uuidHex);
-
-      DebugBLE_print(F("uuidHex =\t")); DebugBLE_println(iBeacon->uuid);
-
-      /* convert given major and minor to hex */
-      String majorHex = byteToHexString(uint8_t((iBeacon->major & 0xFF00) >> 8)) + byteToHexString(uint8_t(iBeacon->major));
-      DebugBLE_print(F("majorHex =\t")); DebugBLE_println(majorHex);
-      String minorHex = byteToHexString(uint8_t((iBeacon->minor & 0xFF00) >> 8)) + byteToHexString(uint8_t(iBeacon->minor));
-      DebugBLE_print(F("minorHex =\t")); DebugBLE_println(minorHex);
-
-
-      /* check for a UUID, major and minor match */
-      int16_t indexUUID = data.indexOf(iBeacon->uuid);
-      if ((indexUUID >= 0) && (data.indexOf(majorHex, indexUUID) >= 0) && (data.indexOf(minorHex, indexUUID) >= 0))
-      {
-        DebugBLE_println(F("match!"));
-        match = true;
-
-        /* process data */
-        int16_t indexMatch = data.indexOf(iBeacon->uuid) - 9;
-        iBeacon->accessAddress = data.substring(indexMatch, indexMatch+8);
-        iBeacon->deviceAddress = data.substring(indexMatch+53, indexMatch+65);
-        iBeacon->major        = hexStringToByte(data.substring(indexMatch+42, indexMatch+44)) << 8;
-        iBeacon->major       |= hexStringToByte(data.substring(indexMatch+44, indexMatch+46));
-        iBeacon->minor         = hexStringToByte(data.substring(indexMatch+46, indexMatch+48)) << 8;
-        iBeacon->minor        |= hexStringToByte(data.substring(indexMatch+48, indexMatch+50));
-        iBeacon->txPower       = hexStringToByte(data.substring(indexMatch+67, indexMatch+68)) << 8;
-        iBeacon->txPower      |= hexStringToByte(data.substring(indexMatch+68, indexMatch+70));
-        iBeacon->txPower      *= -1;
-      }
-      else
-      {
-        DebugBLE_println(F("no match"));
-      };
-    }
-    DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());  // make sure its the same as at the beginning of the function
-
-    return match;
+    return findIBeacon(iBeacon, maxTimeToSearch, true);
   }
 
 /** -------------------------------------------------------------------------
@@ -341,99 +456,9 @@
   --------------------------------------------------------------------------- */
   bool HM11::detectIBeaconUUID(iBeaconData_t *iBeacon, uint16_t maxTimeToSearch)
   {
+    HM11_RAM_PROBE(API_DETECT_IBEACON);
     DebugBLE_println(F("detect iBeacons"));
-
-    bool match = false;
-
-    BLESerial_flush();
-
-    /* find near I-Beacons */
-    String response = getConf(F("DISI"));
-
-    /* if successful: continue reading to get the devices */
-    if (response.indexOf("OK+DISIS") >= 0)
-    {
-      DebugBLE_println(F("search for devices..."));
-      bool timeout = false;
-      uint32_t startMillis_BLE_total = millis();
-      DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());
-      String data = "";
-      iBeacon->accessAddress.reserve(8);
-      iBeacon->deviceAddress.reserve(12);
-      String temp = "";
-      temp.reserve(78);
-      data.reserve(86);
-      //78 = sizeOf(OK+DISC:4C000215:00D7D3EE02E4470E97DA78CFAC4027CC:00C80007BA:000780031354:-071)
-      //86 = sizeOf(OK+DISC:4C000215:00D7D3EE02E4470E97DA78CFAC4027CC:00C80007BA:000780031354:-071OK+DISCE)
-      DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());
-      while(data.indexOf("OK+DISCE") < 0 && !timeout)
-      {
-        if (BLESerial_available() > 0)
-        {
-          if (!match)
-          {
-            data.concat(String(char(BLESerial_read())));
-            if (data.length() >= 78 && data.indexOf("OK+DISCE") < 0)
-            {
-              DebugBLE_print(F("data = ")); DebugBLE_println(data);
-              if (data.indexOf(iBeacon->uuid) >= 0) match = true;
-              else data = ""; // reset String
-            }
-          }
-          else
-          {
-            temp.concat(String(char(BLESerial_read())));
-            if (temp.length() >= 78)
-            {
-              DebugBLE_print(F("temp = ")); DebugBLE_println(temp);
-              temp = "";
-            }
-            else if (temp.indexOf("OK+DISCE") >= 0) data += temp;
-          }
-        }
-
-        if ((millis() - startMillis_BLE_total) >= maxTimeToSearch)
-        {
-          timeout = true;
-          DebugBLE_println(F("timeouted!"));
-        }
-      }
-      DebugBLE_print(F("dt data =\t")); DebugBLE_print((millis() - startMillis_BLE_total)); DebugBLE_println(F("ms"));
-      DebugBLE_print(F("data =\t\t")); DebugBLE_println(data);
-
-      /* HW reset to prevent the "AT+DISCE" */
-      if (timeout)
-      {
-        hwResetBLE();
-        while(BLESerial_available()) BLESerial_read();  //BLESerial_flush();
-      }
-
-      /* check for a UUID match */
-      DebugBLE_print(F("uuidHex =\t")); DebugBLE_println(iBeacon->uuid);
-      if (match)
-      {
-        DebugBLE_println(F("match!"));
-
-        /* process data */
-        int16_t indexMatch = data.indexOf(iBeacon->uuid) - 9;
-        iBeacon->accessAddress = data.substring(indexMatch, indexMatch+8);
-        iBeacon->deviceAddress = data.substring(indexMatch+53, indexMatch+65);
-        iBeacon->major        = hexStringToByte(data.substring(indexMatch+42, indexMatch+44)) << 8;
-        iBeacon->major       |= hexStringToByte(data.substring(indexMatch+44, indexMatch+46));
-        iBeacon->minor         = hexStringToByte(data.substring(indexMatch+46, indexMatch+48)) << 8;
-        iBeacon->minor        |= hexStringToByte(data.substring(indexMatch+48, indexMatch+50));
-        iBeacon->txPower       = hexStringToByte(data.substring(indexMatch+67, indexMatch+68)) << 8;
-        iBeacon->txPower      |= hexStringToByte(data.substring(indexMatch+68, indexMatch+70));
-        iBeacon->txPower      *= -1;
-      }
-      else
-      {
-        DebugBLE_println(F("no match"));
-      };
-    }
-    DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());  // make sure its the same as at the beginning of the function
-
-    return match;
+    return findIBeacon(iBeacon, maxTimeToSearch, false);
   }
 
   //TODO: implement detectIBeacons() (plural)
@@ -481,280 +506,1399 @@
      // }
 
 
-  //TODO: implement sleepBLE and test wakeUpBLE
-
-  // void wakeUpBLE()
-  // {
-  //  DebugBLE_println(F("wakeing up BLE..."));
-
-  //  /* wake up -> send a long random string */
-  //  String wakeUpStr = "";
-  //  wakeUpStr.reserve(200);
-  //  for(int n = 0; n < 200; n++)
-  //  {
-  //    wakeUpStr.concat(char(random(66, 90)));  // 66 = 'B'... 90 = 'Z'
-  //  }
-  //  BLESerial_begin(BAUDRATE0);
-  //  BLESerial_print(wakeUpStr);
-  //  BLESerial_readString();
-  //  BLESerial_begin(baudrate_);
-  //  BLESerial_flush();
-  // }
+/** -------------------------------------------------------------------------
+  * \fn     startIBeaconScan
+  * \brief  starts a non-blocking scan for near iBeacons
+  *
+  * \param  maxTimeToSearch   max time to search for iBeacons in ms
+  * \return true if the scan has been started
+  --------------------------------------------------------------------------- */
+  bool HM11::startIBeaconScan(uint16_t maxTimeToSearch)
+  {
+    HM11_RAM_PROBE(API_START_SCAN);
+    DebugBLE_println(F("start iBeacon scan"));
+    scanDevices_ = false;
+    return startScan(CMD_DISI, maxTimeToSearch);
+  }
 
 /** -------------------------------------------------------------------------
-  * \fn     getMacAddress
-  * \brief  reads the mac address of the BLE module
+  * \fn     pollIBeaconScan
+  * \brief  processes the received scan data without blocking
   *
-  * \return mac address
+  * \param  record  record structure pointer which gets the detected iBeacon
+  * \return SCAN_RECORD if record has been filled, SCAN_RUNNING while the scan
+  *         is going on, SCAN_DONE or SCAN_FAILED if the scan has ended
   --------------------------------------------------------------------------- */
-  String HM11::getMacAddress()
+  HM11::scanState_t HM11::pollIBeaconScan(iBeaconRecord_t *record)
   {
-    String macAddr = F("error");
-    macAddr.reserve(12);
-    String response = getConf(F("ADDR"));
-    if (response.startsWith(F("OK")))
+    HM11_RAM_PROBE(API_POLL_SCAN);
+    if (scanDevices_) return SCAN_IDLE;
+    if (!isScanning()) return scanState_;
+
+    while (BLESerial_available())
     {
-      response = response.substring(8);   // OK+ADDR:MACAddress
-      if (response.length() == 12) macAddr = response;
+      scanState_t state = parseScanCharacter(char(BLESerial_read()));
+      if (state == SCAN_RECORD)
+      {
+        *record = scanRecord_;
+        return SCAN_RECORD;
+      }
+      if (state == SCAN_DONE)
+      {
+        DebugBLE_print(F("dt scan =\t")); DebugBLE_print((BLE_millis() - scanStartMillis_)); DebugBLE_println(F("ms"));
+        scanState_ = SCAN_DONE;
+        setModuleState(baseState_);
+        return SCAN_DONE;
+      }
     }
-    return macAddr;
+
+    if ((BLE_millis() - scanStartMillis_) >= scanTimeout_)
+    {
+      DebugBLE_println(F("scan timeouted!"));
+      stopScan();
+      scanState_ = SCAN_FAILED;
+      setModuleState(baseState_);
+    }
+    return scanState_;
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     connectToMacAddress
-  * \brief  connects to given mac Address
+  * \fn     setDiscoveryDetails
+  * \brief  sets which details the generic discovery reports (AT+SHOW)
   *
-  * \param  macAddr mac address
-  * \param  master  connect as master (true) or slave (false)
-  * \return None
+  * \param  show  0: mac address only, 1: + name, 2: + RSSI, 3: + both
+  *               (2 and 3 depend on the firmware version)
+  * \return STATUS_OK if it succeeded
   --------------------------------------------------------------------------- */
-  void HM11::connectToMacAddress(String macAddr, bool master)
+  HM11::status_t HM11::setDiscoveryDetails(uint8_t show)
   {
-    setConf(F("IMME1"));      // module work type (1 = responds only to AT-commands)
-    setConf("ROLE" + String(master));
-    swResetBLE();
-    setConf("CON" + macAddr);
+    if (show > 3) return STATUS_INVALID;
+    return setConf(CMD_SHOW, char('0' + show));
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     readChar
-  * \brief  reads and converts a character from BLESerial
+  * \fn     startDiscovery
+  * \brief  starts a non-blocking discovery of normal BLE devices
   *
-  * \param  None
-  * \return character
+  * \param  maxTimeToSearch   max time to search for devices in ms
+  * \return true if the discovery has been started
   --------------------------------------------------------------------------- */
-  char HM11::readChar()
+  bool HM11::startDiscovery(uint16_t maxTimeToSearch)
   {
-    static uint8_t lastB = 0;
-    uint8_t b = BLESerial_read();
-    if (lastB == 13 && b == 225) b = 10; // handle cr/lf
-    if (b >= 128) b -= 128;
-    lastB = b;
-    return char(b);
+    HM11_RAM_PROBE(API_START_SCAN);
+    DebugBLE_println(F("start discovery"));
+    if (isScanning() || setRole(true) != STATUS_OK) return false;
+    scanDevices_ = true;
+    discState_ = DISC_PREFIX;
+    discPos_ = 0;
+    discPending_ = false;
+    return startScan(CMD_DISC, maxTimeToSearch);
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     handshaking
-  * \brief  handshaking to sync a P2P connection
+  * \fn     pollDiscovery
+  * \brief  processes the received discovery data without blocking, a device
+  *         is handed out as soon as its next line (or the end) has been
+  *         received because the name and RSSI lines are optional
   *
-  * \param  master          sync as master (true) or slave (false)
-  * \param  handshakeChar   random handshake character
-  * \return true if it succeeded
+  * \param  record  record structure pointer which gets the found device
+  * \return SCAN_RECORD if record has been filled, SCAN_RUNNING while the
+  *         discovery is going on, SCAN_DONE or SCAN_FAILED if it has ended
   --------------------------------------------------------------------------- */
-  bool HM11::handshaking(bool master, char handshakeChar)
+  HM11::scanState_t HM11::pollDiscovery(deviceRecord_t *record)
   {
-    const uint16_t timeout = 10000;
-    const uint16_t dtMax = 100;
-    uint32_t msTimeout = millis();
-
-    /* empty the recive buffer */
-    while(BLESerial_available())
-    {
-      BLESerial_read();
-      if ((millis() - msTimeout) >= timeout) return false;
-    }
-    msTimeout = millis();
+    HM11_RAM_PROBE(API_POLL_SCAN);
+    if (!scanDevices_) return SCAN_IDLE;
+    if (!isScanning()) return scanState_;
 
-    /* handshaking */
-    uint32_t ms = millis();
-    if (master)
+    while (BLESerial_available())
     {
-      DebugBLE_print(F("wait for handshake char..."));
-      while(BLESerial_read() != handshakeChar)
+      scanState_t state = parseDiscoveryCharacter(char(BLESerial_read()), record);
+      if (state == SCAN_RECORD) return SCAN_RECORD;
+      if (state == SCAN_DONE)
       {
-        ms = millis();
-
-        DebugBLE_print(F("."));
-        if ((millis() - msTimeout) >= timeout) return false;
-        while(!BLESerial_available() && (millis() - ms) < dtMax);
+        DebugBLE_print(F("dt discovery =\t")); DebugBLE_print((BLE_millis() - scanStartMillis_)); DebugBLE_println(F("ms"));
+        scanState_ = SCAN_DONE;
+        setModuleState(baseState_);
+        if (!discPending_) return SCAN_DONE;
+        *record = discRecord_;   // last device -> SCAN_DONE with the next call
+        discPending_ = false;
+        return SCAN_RECORD;
       }
-      BLESerial_print(String(handshakeChar));
-      delay(dtMax);
     }
-    else
-    {
-      DebugBLE_print(F("send handshake char..."));
-      while(BLESerial_read() != handshakeChar)
-      {
-        BLESerial_print(String(handshakeChar));
-        ms = millis();
 
-        DebugBLE_print(F("."));
-        if ((millis() - msTimeout) >= timeout) return false;
-        while(!BLESerial_available() && (millis() - ms) < dtMax);
-      }
-      uint16_t dt = millis() - ms;
-      // DebugBLE_print(F("dt = ")); DebugBLE_println(dt);
-      delay(dtMax - dt/2);
+    if ((BLE_millis() - scanStartMillis_) >= scanTimeout_)
+    {
+      DebugBLE_println(F("discovery timeouted!"));
+      stopScan();
+      scanState_ = SCAN_FAILED;
+      setModuleState(baseState_);
     }
-    DebugBLE_println();
-    DebugBLE_println(F("handshake succeeded!"));
-    return true;
+    return scanState_;
   }
+#endif
 
 /** -------------------------------------------------------------------------
-  * \fn     forceRenew
-  * \brief  try this if you can not communicate with the BLE module anymore
+  * \fn     sleepBLE
+  * \brief  puts the BLE module to sleep ("AT+SLEEP")
+  *
+  * \return STATUS_OK if the module went to sleep
   --------------------------------------------------------------------------- */
-  void HM11::forceRenew()
+  HM11::status_t HM11::sleepBLE()
   {
-    baudrate_t baudratesArray[] = {BAUDRATE0, BAUDRATE1, BAUDRATE2, BAUDRATE3, BAUDRATE4};
-    enable();
-    for (uint8_t i = 0; i < sizeof(baudratesArray)/sizeof(baudrate_t); i++)
-    {
-      DebugBLE_println(baudratesArray[i]);
-      BLESerial_begin(baudratesArray[i]);
-      while(!BLESerial_ready());
-      for (uint8_t n = 0; n < 5; n++) sendDirectBLECommand(F("AT"));
-      for (uint8_t n = 0; (n < 5) && !setConf(F("RENEW")); n++) delay(MAX_DELAY_AFTER_SW_RESET_BLE);
-    }
-    disable();
+    HM11_RAM_PROBE(API_SLEEP);
+    status_t status = setConf(CMD_SLEEP, "", &NO_RETRY);
+    if (status == STATUS_OK) setModuleState(STATE_SLEEPING);
+    return status;
   }
 
-/* ======================== Public class Functions ========================== */
 /** -------------------------------------------------------------------------
-  * \fn     byteToHexString
-  * \brief  converts given hex byte to a String with two characters
+  * \fn     wakeUpBLE
+  * \brief  wakes the BLE module up with a string of more than 80
+  *         characters (the module answers "OK+WAKE")
   *
-  * \param  hex   hex byte
-  * \return Strig with two HEX characters
+  * \return true if the module responds again
   --------------------------------------------------------------------------- */
-  String HM11::byteToHexString(uint8_t hex)
+  bool HM11::wakeUpBLE()
   {
-    String str;
-    str.reserve(2);
-    str.concat(nibbleToHexCharacter((hex & 0xF0) >> 4));
-    str.concat(nibbleToHexCharacter(hex & 0x0F));
-    return str;
+    HM11_RAM_PROBE(API_SLEEP);
+    DebugBLE_println(F("wakeing up BLE..."));
+    for (uint8_t n = 0; n < WAKE_UP_LENGTH; n++) BLESerial_write('W');
+    BLE_delay(commandTimeout_);
+    while(BLESerial_available()) BLESerial_read();  // "OK+WAKE"
+    bool awake = isAlive() || isAlive();
+    if (awake) setModuleState(baseState_);
+    return awake;
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     hexStringToByte
-  * \brief  converts given hex String with two characters to a byte
+  * \fn     getModuleState
+  * \brief  returns the state of the BLE module as tracked by the library
   *
-  * \param  str   hex String
-  * \return hex byte
+  * \return module state (see enumerator in the header file)
   --------------------------------------------------------------------------- */
-  uint8_t HM11::hexStringToByte(String str)
+  HM11::moduleState_t HM11::getModuleState()
   {
-    return ((hexCharacterToNibble(str[0]) << 4) & 0xF0) | (hexCharacterToNibble(str[1]) & 0x0F);
+    return moduleState_;
   }
 
-/* ======================= Private member Functions ========================= */
+#if HM11_FEATURE_ENERGY
 /** -------------------------------------------------------------------------
-  * \fn     hwResetBLE
-  * \brief  resets BLE module by HW
+  * \fn     setCurrentProfile
+  * \brief  sets the supply current per module state (e.g. measured)
+  *
+  * \param  profile  currents in uA (see struct in the header file)
   --------------------------------------------------------------------------- */
-  void HM11::hwResetBLE()
+  void HM11::setCurrentProfile(const currentProfile_t *profile)
   {
-    clearBit(*rstPort_, rstPin_);
-    delay(RESET_DELAY);
-    setBit(*rstPort_, rstPin_);
-    uint32_t ms = millis();
-    while(!sendDirectBLECommand(F("AT")).startsWith(F("OK")) && ((millis() - ms) < MAX_DELAY_AFTER_HW_RESET_BLE));
+    currentProfile_ = *profile;
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     swResetBLE
-  * \brief  resets BLE module by SW
+  * \fn     getStateTime
+  * \brief  returns the time spent in a module state
+  *
+  * \param  state    see enumerator in the header file
+  * \return time in ms (including the running state)
   --------------------------------------------------------------------------- */
-  void HM11::swResetBLE()
+  uint32_t HM11::getStateTime(moduleState_t state)
   {
-    setConf(F("RESET"));
-    uint32_t ms = millis();
-    /* first wait until RESET starts to work (~582ms)... */
-    while(sendDirectBLECommand(F("AT")).startsWith(F("OK")) && ((millis() - ms) < MAX_DELAY_AFTER_SW_RESET_BLE));
-    /* then wait until the BLE module is ready again (~120ms) */
-    while(!sendDirectBLECommand(F("AT")).startsWith(F("OK")) && ((millis() - ms) < MAX_DELAY_AFTER_SW_RESET_BLE));
+    if (state >= STATE_COUNT) return 0;
+    uint32_t t = stateTime_[state];
+    if (state == moduleState_) t += BLE_millis() - stateSince_;
+    return t;
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     renewBLE
-  * \brief  restores BLE module to factory default
+  * \fn     getCharge
+  * \brief  estimates the charge drawn by the module, i.e. the time per
+  *         state times the current of the profile
   *
-  * \return true if it succeeded
+  * \return charge in uAh
   --------------------------------------------------------------------------- */
-  bool HM11::renewBLE()
+  uint32_t HM11::getCharge()
   {
-    setConf(F("RENEW"));              // restore all setup to factory default
-    uint32_t ms = millis();
-    /* first wait until RENEW starts to work (~327ms)... */
-    while(!sendDirectBLECommand(F("AT")).startsWith(F("OK")) && ((millis() - ms) < MAX_DELAY_AFTER_SW_RESET_BLE));
-    /* then wait while the BLE module is busy (~250ms)... */
-    while(sendDirectBLECommand(F("AT")).startsWith(F("OK")) && ((millis() - ms) < MAX_DELAY_AFTER_SW_RESET_BLE));
-    /* then wait until the BLE module is ready again (~230ms) */
-    while(!sendDirectBLECommand(F("AT")).startsWith(F("OK")) && ((millis() - ms) < MAX_DELAY_AFTER_SW_RESET_BLE));
-    return setBaudrate();
+    uint64_t charge = 0;   // in uA * ms
+    for (uint8_t i = 0; i < STATE_COUNT; i++) charge += uint64_t(getStateTime(moduleState_t(i))) * currentProfile_.current[i];
+    return uint32_t(charge / 3600000UL);
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     setConf
-  * \brief  configures BLE module by writing given AT command
-  *
-  * \param  cmd  AT command
-  * \return ture if it succeeded
+  * \fn     resetEnergy
+  * \brief  restarts the time and charge accounting
   --------------------------------------------------------------------------- */
-  bool HM11::setConf(String cmd)
+  void HM11::resetEnergy()
   {
-    String response = sendDirectBLECommand("AT+" + cmd);
-    return response.indexOf("OK") > -1 ? true : false;
+    memset(stateTime_, 0, sizeof(stateTime_));
+    stateSince_ = BLE_millis();
   }
+#endif
 
 /** -------------------------------------------------------------------------
-  * \fn     getConf
-  * \brief  gets configured value of the BLE module with given AT command
-  *
-  * \param  cmd  AT command
-  * \return configured value as a string
+  * \fn     stopScan
+  * \brief  aborts a running scan
   --------------------------------------------------------------------------- */
-  String HM11::getConf(String cmd)
+  void HM11::stopScan()
   {
-    return sendDirectBLECommand("AT+" + cmd + "?");
+    if (!isScanning()) return;
+    scanState_ = SCAN_IDLE;
+
+    /* HW reset to prevent the "AT+DISCE" */
+    hwResetBLE();
+    while(BLESerial_available()) BLESerial_read();
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     setBaudrate
-  * \brief  sets baudrtae of the BLE module
+  * \fn     isScanning
+  * \brief  returns the scan state of the HM11
   *
-  * \param  baudrate  baudrate (see enumerator in the header file)
-  * \return true if it succeeded
+  * \return true if a scan is running
   --------------------------------------------------------------------------- */
-  bool HM11::setBaudrate(baudrate_t baudrate)
+  bool HM11::isScanning()
   {
-    baudrate_ = baudrate;
-    return setBaudrate();
+    return scanState_ == SCAN_RUNNING || scanState_ == SCAN_RECORD;
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     setBaudrate
-  * \brief  sets baudrtae of the BLE module
+  * \fn     getMacAddress
+  * \brief  reads the mac address of the BLE module
   *
-  * \return true if it succeeded
+  * \param  macAddress  gets the mac address (12 hex digits), unchanged on
+  *                     failure
+  * \return STATUS_OK if it succeeded
   --------------------------------------------------------------------------- */
-  bool HM11::setBaudrate()
+  HM11::status_t HM11::getMacAddress(String &macAddress)
   {
-    bool successful = true;
-    uint32_t currentBaudrate = getBaudrate();
+    HM11_RAM_PROBE(API_GET_MAC_ADDRESS);
+    if (!(conf_.valid & CONF_MAC_ADDRESS))
+    {
+      String response;
+      status_t status = getConf(CMD_ADDR, response);
+      if (status != STATUS_OK) return status;
+      response = response.substring(response.lastIndexOf(':') + 1);   // OK+ADDR:MACAddress
+      if (response.length() != 12) return STATUS_BAD_RESPONSE;
+      for (uint8_t i = 0; i < 12; i++) if (!isHexCharacter(response[i])) return STATUS_BAD_RESPONSE;
+      strcpy(conf_.macAddress, response.c_str());
+      conf_.valid |= CONF_MAC_ADDRESS;
+    }
+    macAddress = conf_.macAddress;
+    return STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     refreshConf
+  * \brief  reads all shadowed settings from the module at once, afterwards
+  *         the getters do not need to communicate with the module anymore
+  *
+  * \return true if all settings could be read
+  --------------------------------------------------------------------------- */
+  bool HM11::refreshConf()
+  {
+    conf_.valid &= ~(CONF_MAC_ADDRESS | CONF_TX_POWER);   // only what is read here
+    String macAddress;
+    txPower_t txPower;
+    bool mac = (getMacAddress(macAddress) == STATUS_OK);
+    return (getTxPower(txPower) == STATUS_OK) && mac;
+  }
+
+#if HM11_FEATURE_CONNECTION
+/** -------------------------------------------------------------------------
+  * \fn     connectToMacAddress
+  * \brief  connects to given mac Address and waits for the link, the role
+  *         setup and its reset are skipped if the module is already
+  *         configured accordingly, a link to another peer is disconnected
+  *
+  * \param  macAddr mac address (12 hex digits)
+  * \param  master  connect as master (true) or slave (false)
+  * \param  timeout max time in ms to wait for the link
+  * \return STATUS_OK if the link is up
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::connectToMacAddress(String macAddr, bool master, uint16_t timeout)
+  {
+    HM11_RAM_PROBE(API_CONNECT);
+    if (!isValidMacAddress(macAddr.c_str())) return STATUS_INVALID;
+    if (linkState_ == LINK_CONNECTED && lastPeerMaster_ == master && macAddr == lastPeer_) return STATUS_OK;
+    if (linkState_ != LINK_DISCONNECTED) disconnect();   // the AT commands would be sent to the peer as data
+
+    strcpy(lastPeer_, macAddr.c_str());
+    lastPeerMaster_ = master;
+    pioKnown_[1] = 0;   // new peer
+    status_t status = startConnect();
+    if (status != STATUS_OK) return status;
+
+    /* "OK+CONNA" (accepted) -> "OK+CONN" or "OK+CONNF"/"OK+CONNE" */
+    while ((BLE_millis() - connectStartMillis_) < timeout)
+    {
+      if (BLESerial_wait(CONN_SETTLE_TIME))
+      {
+        demuxCharacter(char(BLESerial_read()));
+        rxLastMillis_ = BLE_millis();
+      }
+      else settleNotification();   // "OK+CONN" followed by silence -> connected
+      if (linkState_ != LINK_CONNECTING && rxMatchPos_ != 7) break;
+    }
+    commandTime_ += BLE_millis() - connectStartMillis_;
+
+    if (linkState_ == LINK_CONNECTED) return STATUS_OK;
+    if (linkState_ == LINK_CONNECTING)
+    {
+      DebugBLE_println(F("connecting timeouted!"));
+      cancelConnect();
+      String response;
+      readBLEResponse(response, false, commandTimeout_);   // "OK"
+    }
+    return STATUS_NOT_CONNECTED;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setAutoReconnect
+  * \brief  enables the automatic reconnect to the last peer
+  *
+  * \param  enable   true: pollConnection() reconnects after a lost link
+  * \param  timeout  max time in ms to wait for the link per attempt
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11::setAutoReconnect(bool enable, uint16_t timeout)
+  {
+    autoReconnect_ = enable;
+    reconnectTimeout_ = timeout;
+    reconnectBackoff_ = MIN_RECONNECT_BACKOFF;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     pollConnection
+  * \brief  processes module notifications while the link is down and
+  *         reconnects to the last peer with an exponential backoff
+  *         (while connected the notifications are tracked by readChar and
+  *         readData). The reconnect does not wait for the link: "AT+CON" is
+  *         sent and the following calls track "OK+CONN"/"OK+CONNF" until
+  *         the timeout of setAutoReconnect. Only a role setup (e.g. after a
+  *         scan as detector) blocks for the reset of the module.
+  --------------------------------------------------------------------------- */
+  void HM11::pollConnection()
+  {
+    HM11_RAM_PROBE(API_POLL_CONNECTION);
+    if (linkState_ == LINK_CONNECTED || isScanning()) return;
+
+    if (BLESerial_available())
+    {
+      while (BLESerial_available()) demuxCharacter(char(BLESerial_read()));
+      rxLastMillis_ = BLE_millis();
+    }
+    else settleNotification();   // e.g. "OK+CONN" of a central which connected to us
+
+    if (reconnecting_)
+    {
+      if (linkState_ == LINK_CONNECTED) return;   // backoff reset by linkConnected()
+      if (linkState_ == LINK_CONNECTING || rxMatchPos_ == 7)
+      {
+        if ((BLE_millis() - connectStartMillis_) < reconnectTimeout_) return;
+        DebugBLE_println(F("reconnecting timeouted!"));
+        cancelConnect();
+      }
+      reconnecting_ = false;
+      lastDropMillis_ = BLE_millis();
+      reconnectBackoff_ = (reconnectBackoff_ < MAX_RECONNECT_BACKOFF / 2) ? (reconnectBackoff_ * 2) : MAX_RECONNECT_BACKOFF;
+      return;
+    }
+
+    if (!autoReconnect_ || lastPeer_[0] == '\0' || linkState_ != LINK_DISCONNECTED) return;
+    if ((BLE_millis() - lastDropMillis_) < reconnectBackoff_) return;
+
+    DebugBLE_println(F("reconnect..."));
+    reconnecting_ = true;
+    if (startConnect() != STATUS_OK)
+    {
+      connectStartMillis_ = BLE_millis();
+      linkState_ = LINK_DISCONNECTED;   // -> backoff with the next call
+    }
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     disconnect
+  * \brief  drops the link with an "AT" (the module answers "OK+LOST"),
+  *         data which has not been sent yet is discarded
+  --------------------------------------------------------------------------- */
+  void HM11::disconnect()
+  {
+    reconnecting_ = false;
+    if (linkState_ == LINK_DISCONNECTED) return;
+    txTail_ = txHead_;
+    txBackpressure_ = false;
+    linkState_ = LINK_DISCONNECTED;   // deliberate -> not counted as a drop
+    setModuleState(baseState_);
+    writeCommand(CMD_AT, "", false);
+    commandCount_++;
+
+    /* consume the "OK+LOST" */
+    uint32_t ms = BLE_millis();
+    while (((BLE_millis() - ms) < commandTimeout_) && BLESerial_wait(CONN_SETTLE_TIME)) demuxCharacter(char(BLESerial_read()));
+    rxMatchPos_ = 0;
+    rxDataCount_ = 0;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getLinkState
+  * \brief  returns the state of the link (see enumerator in the header file)
+  *
+  * \return link state
+  --------------------------------------------------------------------------- */
+  HM11::linkState_t HM11::getLinkState()
+  {
+    return linkState_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getLinkStats
+  * \brief  returns the connect statistics (see struct in the header file)
+  *
+  * \return link statistics
+  --------------------------------------------------------------------------- */
+  const HM11::linkStats_t *HM11::getLinkStats()
+  {
+    return &linkStats_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     write
+  * \brief  queues data for the connected peer without blocking, the queue
+  *         is drained by pollTx()
+  *
+  * \param  data    data to send
+  * \param  length  number of bytes
+  * \return number of accepted bytes (less than length if the queue is full)
+  --------------------------------------------------------------------------- */
+  uint16_t HM11::write(const uint8_t *data, uint16_t length)
+  {
+    uint16_t accepted = availableForWrite();
+    if (accepted > length) accepted = length;
+    if (accepted == 0) return 0;
+    if (txQueued() == 0) txOldestMillis_ = BLE_millis();
+    txStats_.writes++;
+    txStats_.uncoalescedPackets += (accepted + TX_PACKET_SIZE - 1) / TX_PACKET_SIZE;
+    for (uint16_t i = 0; i < accepted; i++)
+    {
+      txBuffer_[txHead_ & (HM11_TX_BUFFER_SIZE - 1)] = data[i];
+      txHead_++;
+    }
+    if (txQueued() >= TX_HIGH_WATERMARK) txBackpressure_ = true;
+    return accepted;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     write
+  * \brief  queues a string for the connected peer without blocking
+  *
+  * \param  str   null terminated string
+  * \return number of accepted characters
+  --------------------------------------------------------------------------- */
+  uint16_t HM11::write(const char *str)
+  {
+    return write((const uint8_t *)str, strlen(str));
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     availableForWrite
+  * \brief  returns the free space of the TX queue
+  *
+  * \return number of bytes
+  --------------------------------------------------------------------------- */
+  uint16_t HM11::availableForWrite()
+  {
+    return HM11_TX_BUFFER_SIZE - txQueued();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     isTxBackpressured
+  * \brief  backpressure signal with hysteresis: set as soon as the TX queue
+  *         is 3/4 full, cleared when it has been drained to 1/4
+  *
+  * \return true if the producer should back off
+  --------------------------------------------------------------------------- */
+  bool HM11::isTxBackpressured()
+  {
+    return txBackpressure_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setTxRate
+  * \brief  sets the drain rate of the TX queue, the UART rate is the limit
+  *
+  * \param  bytesPerSecond  throughput of the link (e.g. measured end-to-end)
+  --------------------------------------------------------------------------- */
+  void HM11::setTxRate(uint16_t bytesPerSecond)
+  {
+    txRate_ = bytesPerSecond;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setTxCoalescing
+  * \brief  holds small writes (like Nagle's algorithm) until a BLE packet is
+  *         full, maxDelay has passed since the oldest byte or flushTx()
+  *
+  * \param  maxDelay  max time in ms a byte is held (0 -> off)
+  --------------------------------------------------------------------------- */
+  void HM11::setTxCoalescing(uint16_t maxDelay)
+  {
+    txCoalesceDelay_ = maxDelay;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     flushTx
+  * \brief  sends the held data with the next pollTx() (coalescing)
+  --------------------------------------------------------------------------- */
+  void HM11::flushTx()
+  {
+    txFlush_ = (txQueued() > 0);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getTxStats
+  * \brief  returns the TX statistics, the saved air time is estimated from
+  *         the packets the writes would have needed on their own
+  *
+  * \return TX statistics (see struct in the header file)
+  --------------------------------------------------------------------------- */
+  const HM11::txStats_t *HM11::getTxStats()
+  {
+    uint32_t saved = (txStats_.uncoalescedPackets > txStats_.packets) ? txStats_.uncoalescedPackets - txStats_.packets : 0;
+    txStats_.airTimeSaved = saved * TX_PACKET_OVERHEAD_AIR_TIME;
+    return &txStats_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     pollTx
+  * \brief  drains the TX queue into the UART at the pace of the link
+  *         (token bucket, at most one BLE packet per burst), call this in
+  *         the main loop. Data is held while the link is down, so it never
+  *         reaches the module as an AT command.
+  --------------------------------------------------------------------------- */
+  void HM11::pollTx()
+  {
+    uint32_t ms = BLE_millis();
+    uint32_t dt = ms - txLastMillis_;
+    txLastMillis_ = ms;
+    if (linkState_ != LINK_CONNECTED || txQueued() == 0) {txCredit_ = 0; return;}
+
+    /* credit in bytes * 1000 -> no rounding loss at small dt */
+    uint32_t rate = (baudrate_ / 10 < txRate_) ? baudrate_ / 10 : txRate_;
+    txCredit_ += (dt < TX_PACKET_SIZE * 1000UL) ? dt * rate : TX_PACKET_SIZE * 1000UL;
+    if (txCredit_ > TX_PACKET_SIZE * 1000UL) txCredit_ = TX_PACKET_SIZE * 1000UL;
+
+    uint16_t n = txCredit_ / 1000;
+    if (n > txQueued()) n = txQueued();
+    if (txCoalesceDelay_ > 0)
+    {
+      /* hold until a packet is full, the oldest byte is due or flushTx() */
+      uint16_t packet = (txQueued() < TX_PACKET_SIZE) ? txQueued() : TX_PACKET_SIZE;
+      if (packet < TX_PACKET_SIZE && !txFlush_ && (ms - txOldestMillis_) < txCoalesceDelay_) return;
+      if (n < packet) return;   // whole packets only
+      n = packet;
+    }
+    if (n == 0) return;
+    txCredit_ -= n * 1000UL;
+    for (uint16_t i = 0; i < n; i++)
+    {
+      BLESerial_write(txBuffer_[txTail_ & (HM11_TX_BUFFER_SIZE - 1)]);
+      txTail_++;
+    }
+    txStats_.packets++;
+    if (txQueued() == 0) txFlush_ = false;
+    if (txQueued() <= TX_LOW_WATERMARK) txBackpressure_ = false;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setEventCallback
+  * \brief  sets the callback of the module notifications (see readData)
+  *
+  * \param  callback  called with the event (NULL -> none)
+  * \param  context   passed to the callback
+  --------------------------------------------------------------------------- */
+  void HM11::setEventCallback(eventCallback_t callback, void *context)
+  {
+    eventCallback_ = callback;
+    eventContext_ = context;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     readData
+  * \brief  reads the next byte of the application data, the module
+  *         notifications are pulled out of the stream and dispatched to the
+  *         event callback. Bytes which could be the beginning of a
+  *         notification are held until it is decided (max. 7 bytes, or
+  *         CONN_SETTLE_TIME of silence).
+  *
+  * \return received byte or -1 if there is none
+  --------------------------------------------------------------------------- */
+  int16_t HM11::readData()
+  {
+    if (rxDataCount_ == 0)
+    {
+      bool received = false;
+      rxCollect_ = true;
+      while (rxDataCount_ == 0 && BLESerial_available())
+      {
+        demuxCharacter(char(BLESerial_read()));
+        received = true;
+      }
+
+      if (received) rxLastMillis_ = BLE_millis();
+      else settleNotification();
+      rxCollect_ = false;
+    }
+
+    if (rxDataCount_ == 0) return -1;
+    uint8_t b = rxData_[rxDataHead_];
+    rxDataHead_ = (rxDataHead_ + 1) & (RX_DATA_SIZE - 1);
+    rxDataCount_--;
+    return b;
+  }
+#endif
+
+/** -------------------------------------------------------------------------
+  * \fn     readChar
+  * \brief  reads and converts a character from BLESerial
+  *
+  * \param  None
+  * \return character
+  --------------------------------------------------------------------------- */
+  char HM11::readChar()
+  {
+    static uint8_t lastB = 0;
+    uint8_t b = BLESerial_read();
+    if (lastB == 13 && b == 225) b = 10; // handle cr/lf
+    if (b >= 128) b -= 128;
+    lastB = b;
+#if HM11_FEATURE_CONNECTION
+    demuxCharacter(char(b));
+    rxLastMillis_ = BLE_millis();
+#endif
+    return char(b);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setRemoteControlMode
+  * \brief  sets the work mode of the module
+  *
+  * \param  enable  true: remote control mode (a connected peer can set the
+  *                 PIOs of this module), false: transmission mode
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setRemoteControlMode(bool enable)
+  {
+    return setConf(CMD_MODE, enable ? '2' : '0');
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setPIO
+  * \brief  sets the output level of a PIO (skipped if it is already set)
+  *
+  * \param  pin     PIO number (2..11)
+  * \param  level   output level
+  * \param  remote  true: PIO of the connected peer (remote control mode)
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setPIO(uint8_t pin, bool level, bool remote)
+  {
+    HM11_RAM_PROBE(API_PIO);
+    if (pin < MIN_PIO || pin > MAX_PIO) return STATUS_INVALID;
+    return setPIOs(1 << pin, level ? (1 << pin) : 0, remote);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setPIOs
+  * \brief  sets the output levels of several PIOs at once, pins whose
+  *         shadowed level already matches are not sent again
+  *
+  * \param  mask    bit n set -> PIOn gets changed (bits 2..11)
+  * \param  levels  bit n = output level of PIOn
+  * \param  remote  true: PIOs of the connected peer (remote control mode)
+  * \return STATUS_OK if it succeeded, STATUS_NOT_CONNECTED for remote PIOs
+  *         without a link, STATUS_BUSY for local PIOs while linked
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setPIOs(uint16_t mask, uint16_t levels, bool remote)
+  {
+    HM11_RAM_PROBE(API_PIO);
+    status_t status = checkPIOLink(remote);
+    if (status != STATUS_OK) return status;
+    mask &= PIO_MASK;
+    levels &= mask;
+    uint16_t &known = pioKnown_[remote];
+    uint16_t &shadow = pioLevels_[remote];
+
+    /* only pins which are unknown or differ from the shadow */
+    uint16_t changed = mask & (~known | (shadow ^ levels));
+    if (changed == 0) return STATUS_OK;
+
+    if ((changed & (changed - 1)) == 0)
+    {
+      /* a single pin: AT+PIO<pin><level> */
+      uint8_t pin = 0;
+      while (!(changed & (1 << pin))) pin++;
+      char arg[3] = {nibbleToHexCharacter(pin), char('0' + ((levels >> pin) & 1)), '\0'};
+      status = setConf(CMD_PIO, arg);
+    }
+    else if (((known | mask) & PIO_MASK) == PIO_MASK)
+    {
+      /* all levels are known: AT+MPIO<levels as 3 hex digits> in one exchange */
+      uint16_t all = (shadow & ~mask) | levels;
+      char arg[4] = {nibbleToHexCharacter((all >> 8) & 0x0F), nibbleToHexCharacter((all >> 4) & 0x0F), nibbleToHexCharacter(all & 0x0F), '\0'};
+      status = setConf(CMD_MPIO, arg);
+    }
+    else
+    {
+      /* unknown levels would be overwritten by MPIO -> pin by pin */
+      for (uint8_t pin = MIN_PIO; pin <= MAX_PIO; pin++)
+      {
+        if (!(changed & (1 << pin))) continue;
+        char arg[3] = {nibbleToHexCharacter(pin), char('0' + ((levels >> pin) & 1)), '\0'};
+        status_t pinStatus = setConf(CMD_PIO, arg);
+        if (pinStatus == STATUS_OK) known |= (1 << pin);
+        else {status = pinStatus; changed &= ~(1 << pin);}
+      }
+      shadow = (shadow & ~changed) | (levels & changed);
+      return status;
+    }
+
+    if (status == STATUS_OK)
+    {
+      known |= changed;
+      shadow = (shadow & ~changed) | (levels & changed);
+    }
+    else known &= ~changed;
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getPIO
+  * \brief  gets the level of a PIO (from the shadow if it is known)
+  *
+  * \param  pin     PIO number (2..11)
+  * \param  remote  true: PIO of the connected peer (remote control mode)
+  * \return level (0 or 1) or -1 if it failed
+  --------------------------------------------------------------------------- */
+  int8_t HM11::getPIO(uint8_t pin, bool remote)
+  {
+    HM11_RAM_PROBE(API_PIO);
+    if (pin < MIN_PIO || pin > MAX_PIO) return -1;
+    if (checkPIOLink(remote) != STATUS_OK) return -1;
+    if (pioKnown_[remote] & (1 << pin)) return (pioLevels_[remote] >> pin) & 1;
+
+    String response;
+    char arg[2] = {nibbleToHexCharacter(pin), '\0'};
+    if (getConf(CMD_PIO, response, arg) != STATUS_OK) return -1;  // "OK+PIO2:1"
+    char level = response[response.length() - 1];
+    if (level != '0' && level != '1') return -1;
+    pioKnown_[remote] |= (1 << pin);
+    if (level == '1') pioLevels_[remote] |= (1 << pin);
+    else pioLevels_[remote] &= ~(1 << pin);
+    return level - '0';
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     checkPIOLink
+  * \brief  remote PIO commands are sent over the link, local ones must not
+  *         be (the module would forward them to the peer as data)
+  *
+  * \param  remote  true: PIOs of the connected peer
+  * \return STATUS_OK if the command can be sent
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::checkPIOLink(bool remote)
+  {
+#if HM11_FEATURE_CONNECTION
+    if (remote && linkState_ != LINK_CONNECTED) return STATUS_NOT_CONNECTED;
+    if (!remote && linkState_ != LINK_DISCONNECTED) return STATUS_BUSY;
+#else
+    if (remote) return STATUS_NOT_CONNECTED;   // no link without the connection feature
+#endif
+    return STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     invalidatePIOShadow
+  * \brief  forgets the shadowed PIO levels (e.g. after the peer changed)
+  --------------------------------------------------------------------------- */
+  void HM11::invalidatePIOShadow()
+  {
+    pioKnown_[0] = pioKnown_[1] = 0;
+  }
+
+#if HM11_FEATURE_HANDSHAKING
+/** -------------------------------------------------------------------------
+  * \fn     handshaking
+  * \brief  handshaking to sync a P2P connection
+  *
+  * \param  master          sync as master (true) or slave (false)
+  * \param  handshakeChar   random handshake character
+  * \return true if it succeeded
+  --------------------------------------------------------------------------- */
+  bool HM11::handshaking(bool master, char handshakeChar)
+  {
+    HM11_RAM_PROBE(API_HANDSHAKING);
+    const uint16_t timeout = 10000;
+    const uint16_t dtMax = 100;
+    uint32_t msTimeout = BLE_millis();
+
+    /* empty the recive buffer */
+    while(BLESerial_available())
+    {
+      BLESerial_read();
+      if ((BLE_millis() - msTimeout) >= timeout) return false;
+    }
+    msTimeout = BLE_millis();
+
+    /* handshaking */
+    uint32_t ms = BLE_millis();
+    if (master)
+    {
+      DebugBLE_print(F("wait for handshake char..."));
+      while(BLESerial_read() != handshakeChar)
+      {
+        ms = BLE_millis();
+
+        DebugBLE_print(F("."));
+        if ((BLE_millis() - msTimeout) >= timeout) return false;
+        while(((BLE_millis() - ms) < dtMax) && !BLESerial_wait(dtMax - (BLE_millis() - ms)));
+      }
+      BLESerial_print(String(handshakeChar));
+      BLE_delay(dtMax);
+    }
+    else
+    {
+      DebugBLE_print(F("send handshake char..."));
+      while(BLESerial_read() != handshakeChar)
+      {
+        BLESerial_print(String(handshakeChar));
+        ms = BLE_millis();
+
+        DebugBLE_print(F("."));
+        if ((BLE_millis() - msTimeout) >= timeout) return false;
+        while(((BLE_millis() - ms) < dtMax) && !BLESerial_wait(dtMax - (BLE_millis() - ms)));
+      }
+      uint16_t dt = BLE_millis() - ms;
+      // DebugBLE_print(F("dt = ")); DebugBLE_println(dt);
+      BLE_delay(dtMax - dt/2);
+    }
+    DebugBLE_println();
+    DebugBLE_println(F("handshake succeeded!"));
+    return true;
+  }
+#endif
+
+/** -------------------------------------------------------------------------
+  * \fn     recover
+  * \brief  checks the BLE module and recovers it if it does not respond,
+  *         each step is only tried if the previous one failed:
+  *         ping, resync, HW reset, baudrate detection, renew
+  *         (an "AT" drops an existing connection)
+  *
+  * \return step which succeeded (RECOVERY_FAILED if none did)
+  --------------------------------------------------------------------------- */
+  HM11::recoveryStep_t HM11::recover()
+  {
+    HM11_RAM_PROBE(API_RECOVER);
+    uint32_t ms = BLE_millis();
+    if (!isEnabled()) enable();
+
+    uint8_t step = RECOVERY_PING;
+    while (step < RECOVERY_FAILED && !recoverStep(recoveryStep_t(step))) step++;
+    if (step > RECOVERY_PING) invalidateShadow();   // the module did not respond -> its settings are in doubt
+    DebugBLE_print(F("recovery step = ")); DebugBLE_println(step);
+
+    uint32_t duration = BLE_millis() - ms;
+    recoveryStats_.lastStep = recoveryStep_t(step);
+    recoveryStats_.lastDuration = (duration < 0xFFFF) ? uint16_t(duration) : 0xFFFF;
+    if (recoveryStats_.lastDuration > recoveryStats_.maxDuration) recoveryStats_.maxDuration = recoveryStats_.lastDuration;
+    recoveryStats_.steps[step]++;
+    return recoveryStep_t(step);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getRecoveryStats
+  * \brief  returns the recovery statistics (see struct in the header file)
+  *
+  * \return recovery statistics
+  --------------------------------------------------------------------------- */
+  const HM11::recoveryStats_t *HM11::getRecoveryStats()
+  {
+    return &recoveryStats_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getFirmwareVersion
+  * \brief  returns the firmware version queried by begin()
+  *
+  * \return e.g. 540 for "HMSoft V540", 0 if it is unknown
+  --------------------------------------------------------------------------- */
+  uint16_t HM11::getFirmwareVersion()
+  {
+    return firmwareVersion_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getMillis
+  * \brief  returns the time base of the backend, components built on the
+  *         driver (e.g. HM11_Poller) use it instead of millis() to run on
+  *         every backend (e.g. the virtual time of HM11_Simulator)
+  *
+  * \return time in ms
+  --------------------------------------------------------------------------- */
+  uint32_t HM11::getMillis()
+  {
+    return BLE_millis();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getCommandCount
+  * \brief  returns the number of AT commands sent since startup
+  *
+  * \return number of AT commands
+  --------------------------------------------------------------------------- */
+  uint32_t HM11::getCommandCount()
+  {
+    return commandCount_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getCommandTime
+  * \brief  returns the total time spent waiting for command responses
+  *
+  * \return time in ms
+  --------------------------------------------------------------------------- */
+  uint32_t HM11::getCommandTime()
+  {
+    return commandTime_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getRAMUsage
+  * \brief  returns the peak RAM usage of a public API call (AVR only)
+  *
+  * \param  api  see enumerator in the header file
+  * \return peak stack and heap usage or NULL without HM11_RAM_PROFILING
+  --------------------------------------------------------------------------- */
+  const HM11::ramUsage_t *HM11::getRAMUsage(api_t api)
+  {
+  #ifdef HM11_RAM_PROFILING
+    return (api < API_COUNT) ? &ramUsage_[api] : NULL;
+  #else
+    (void)api;
+    return NULL;
+  #endif
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     resetRAMUsage
+  * \brief  clears the recorded peak RAM usage
+  --------------------------------------------------------------------------- */
+  void HM11::resetRAMUsage()
+  {
+  #ifdef HM11_RAM_PROFILING
+    memset(ramUsage_, 0, sizeof(ramUsage_));
+  #endif
+  }
+
+/* ======================== Public class Functions ========================== */
+/** -------------------------------------------------------------------------
+  * \fn     byteToHexString
+  * \brief  converts given hex byte to a String with two characters
+  *
+  * \param  hex   hex byte
+  * \return Strig with two HEX characters
+  --------------------------------------------------------------------------- */
+  String HM11::byteToHexString(uint8_t hex)
+  {
+    String str;
+    str.reserve(2);
+    str.concat(nibbleToHexCharacter((hex & 0xF0) >> 4));
+    str.concat(nibbleToHexCharacter(hex & 0x0F));
+    return str;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     hexStringToByte
+  * \brief  converts given hex String with two characters to a byte
+  *
+  * \param  str   hex String
+  * \return hex byte
+  --------------------------------------------------------------------------- */
+  uint8_t HM11::hexStringToByte(String str)
+  {
+    return ((hexCharacterToNibble(str[0]) << 4) & 0xF0) | (hexCharacterToNibble(str[1]) & 0x0F);
+  }
+
+/* ======================= Private member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     hwResetBLE
+  * \brief  resets BLE module by HW
+  --------------------------------------------------------------------------- */
+  void HM11::hwResetBLE()
+  {
+    invalidatePIOShadow();   // the settings in the flash survive a reset, the pins do not
+    setModuleState(STATE_RESETTING);
+    clearBit(*rstPort_, rstPin_);
+    BLE_delay(RESET_DELAY);
+    setBit(*rstPort_, rstPin_);
+    uint32_t ms = BLE_millis();
+    while(!isAlive() && ((BLE_millis() - ms) < hwResetTime_));
+    setModuleState(baseState_);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setIBeaconMode
+  * \brief  fixed part of the iBeacon setup (see setupAsIBeacon)
+  *
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setIBeaconMode()
+  {
+    status_t status = setConf(CMD_ADTY, '3');                  // advertising type (3 = advertising only)
+    if (status == STATUS_OK) status = setConf(CMD_IBEA, '1');  // enable iBeacon
+    if (status == STATUS_OK) status = setConf(CMD_DELO, '2');  // iBeacon deploy mode (2 = broadcast only)
+    if (status == STATUS_OK) status = setConf(CMD_PWRM, '1');  // auto sleep OFF
+    if (status == STATUS_OK)
+    {
+      conf_.valid |= CONF_IBEACON;
+      baseState_ = STATE_ADVERTISING;
+      setModuleState(baseState_);
+    }
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setIBeaconId
+  * \brief  sets major or minor ("AT+MARJ0x1234") and shadows it
+  *
+  * \param  cmd    CMD_MARJ or CMD_MINO
+  * \param  value  major or minor
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setIBeaconId(command_t cmd, uint16_t value)
+  {
+    char arg[7] = {'0', 'x', toHexCharacter(value, 12), toHexCharacter(value, 8),
+      toHexCharacter(value, 4), toHexCharacter(value, 0), '\0'};
+    uint8_t flag = (cmd == CMD_MARJ) ? CONF_MAJOR : CONF_MINOR;
+    status_t status = setConf(cmd, arg);
+    if (status != STATUS_OK) {conf_.valid &= ~flag; return status;}
+    if (cmd == CMD_MARJ) conf_.major = value;
+    else conf_.minor = value;
+    conf_.valid |= flag;
+    return STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setRole
+  * \brief  sets the work type (IMME1) and the role, the reset which is needed
+  *         to activate them is skipped if they are already active
+  *
+  * \param  master  central (true) or peripheral (false)
+  * \return STATUS_OK if it succeeded, STATUS_BUSY while a link is up
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setRole(bool master)
+  {
+    if ((conf_.valid & CONF_ROLE) && conf_.master == master) return STATUS_OK;
+#if HM11_FEATURE_CONNECTION
+    if (linkState_ != LINK_DISCONNECTED) return STATUS_BUSY;   // the AT commands would be sent to the peer as data
+#endif
+
+    status_t status = setConf(CMD_IMME, '1');   // module work type (1 = responds only to AT-commands)
+    if (status == STATUS_OK) status = setConf(CMD_ROLE, master ? '1' : '0');  // module role (1 = central = master)
+    if (status != STATUS_OK) return status;
+    baseState_ = master ? STATE_IDLE : STATE_ADVERTISING;
+    swResetBLE();
+
+    conf_.master = master;
+    conf_.valid |= CONF_ROLE;
+    conf_.valid &= ~CONF_IBEACON;   // IMME1 and the new role
+    return STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     invalidateShadow
+  * \brief  forgets all shadowed settings (after restoring or an unresponsive
+  *         module), resets only forget the pin states
+  --------------------------------------------------------------------------- */
+  void HM11::invalidateShadow()
+  {
+    conf_.valid = 0;
+    invalidatePIOShadow();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     swResetBLE
+  * \brief  resets BLE module by SW
+  --------------------------------------------------------------------------- */
+  void HM11::swResetBLE()
+  {
+    invalidatePIOShadow();   // the settings in the flash survive a reset, the pins do not
+    setConf(CMD_RESET, "", &NO_RETRY);
+    setModuleState(STATE_RESETTING);
+    uint32_t ms = BLE_millis();
+    /* first wait until RESET starts to work (~582ms)... */
+    while(isAlive() && ((BLE_millis() - ms) < swResetTime_));
+    /* then wait until the BLE module is ready again (~120ms) */
+    while(!isAlive() && ((BLE_millis() - ms) < swResetTime_));
+    setModuleState(baseState_);
+  }
+
+#if HM11_FEATURE_RENEW
+/** -------------------------------------------------------------------------
+  * \fn     renewBLE
+  * \brief  restores BLE module to factory default
+  *
+  * \return true if it succeeded
+  --------------------------------------------------------------------------- */
+  bool HM11::renewBLE()
+  {
+    invalidateShadow();
+    setConf(CMD_RENEW, "", &NO_RETRY);   // restore all setup to factory default
+    baseState_ = STATE_ADVERTISING;
+    setModuleState(STATE_RESETTING);
+    uint32_t ms = BLE_millis();
+    /* first wait until RENEW starts to work (~327ms)... */
+    while(!isAlive() && ((BLE_millis() - ms) < swResetTime_));
+    /* then wait while the BLE module is busy (~250ms)... */
+    while(isAlive() && ((BLE_millis() - ms) < swResetTime_));
+    /* then wait until the BLE module is ready again (~230ms) */
+    while(!isAlive() && ((BLE_millis() - ms) < swResetTime_));
+    setModuleState(baseState_);
+    return setBaudrate();
+  }
+#endif
+
+/** -------------------------------------------------------------------------
+  * \fn     setConf
+  * \brief  configures BLE module by writing given AT command
+  *
+  * \param  cmd     AT verb (see COMMAND_TABLE)
+  * \param  arg     argument which follows the verb
+  * \param  policy  retry policy (NULL -> policy of the instance)
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setConf(command_t cmd, const char *arg, const retryPolicy_t *policy)
+  {
+    String response;
+    status_t status;
+    for (uint8_t n = 0; ((status = sendCommand(cmd, arg, false, response)) != STATUS_OK) && retryBackoff(status, n, policy); n++);
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setConf
+  * \brief  configures BLE module by writing given AT command
+  *
+  * \param  cmd     AT verb (see COMMAND_TABLE)
+  * \param  arg     single character argument (e.g. a digit)
+  * \param  policy  retry policy (NULL -> policy of the instance)
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setConf(command_t cmd, char arg, const retryPolicy_t *policy)
+  {
+    char str[2] = {arg, '\0'};
+    return setConf(cmd, str, policy);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setConf_P
+  * \brief  configures BLE module by writing given AT command from PROGMEM
+  *
+  * \param  cmd     complete AT command in PROGMEM (including the "AT+")
+  * \param  policy  retry policy (NULL -> policy of the instance)
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::setConf_P(PGM_P cmd, const retryPolicy_t *policy)
+  {
+    String response;
+    status_t status;
+    for (uint8_t n = 0; ((status = sendDirectBLECommand_P(cmd, response)) != STATUS_OK) && retryBackoff(status, n, policy); n++);
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getConf
+  * \brief  gets configured value of the BLE module with given AT command
+  *
+  * \param  cmd       AT verb (see COMMAND_TABLE)
+  * \param  response  configured value as a string
+  * \param  arg       argument which follows the verb (before the '?')
+  * \param  policy    retry policy (NULL -> policy of the instance)
+  * \return STATUS_OK if it succeeded
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::getConf(command_t cmd, String &response, const char *arg, const retryPolicy_t *policy)
+  {
+    status_t status;
+    for (uint8_t n = 0; ((status = sendCommand(cmd, arg, true, response)) != STATUS_OK) && retryBackoff(status, n, policy); n++);
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     retryBackoff
+  * \brief  decides if a failed command gets retried and waits the backoff
+  *         (only timeouts are transient, everything else fails fast)
+  *
+  * \param  status   status of the failed attempt
+  * \param  attempt  number of the failed attempt (0 = first)
+  * \param  policy   retry policy (NULL -> policy of the instance)
+  * \return true if the command should be retried
+  --------------------------------------------------------------------------- */
+  bool HM11::retryBackoff(status_t status, uint8_t attempt, const retryPolicy_t *policy)
+  {
+    if (policy == NULL) policy = &retryPolicy_;
+    if (status != STATUS_TIMEOUT || attempt >= policy->retries) return false;
+    uint32_t backoff = uint32_t(policy->backoff) << attempt;
+    BLE_delay((backoff < policy->maxBackoff) ? backoff : policy->maxBackoff);
+    DebugBLE_print(F("retry #")); DebugBLE_println(attempt + 1);
+    return true;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     isAlive
+  * \brief  checks once if the BLE module responds to "AT"
+  *
+  * \return true if the module responded with "OK"
+  --------------------------------------------------------------------------- */
+  bool HM11::isAlive()
+  {
+    String response;
+    return sendCommand(CMD_AT, "", false, response) == STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setModuleState
+  * \brief  changes the module state and books the time of the previous one
+  *
+  * \param  state    see enumerator in the header file
+  --------------------------------------------------------------------------- */
+  void HM11::setModuleState(moduleState_t state)
+  {
+#if HM11_FEATURE_ENERGY
+    uint32_t ms = BLE_millis();
+    stateTime_[moduleState_] += ms - stateSince_;
+    stateSince_ = ms;
+#endif
+    moduleState_ = state;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     detectFirmware
+  * \brief  queries the firmware version ("HMSoft V540") and loads the
+  *         capabilities and timings of FIRMWARE_TABLE
+  --------------------------------------------------------------------------- */
+  void HM11::detectFirmware()
+  {
+    String response;
+    if (isScanning()) return;
+    writeCommand(CMD_VERS, "", true);
+    readBLEResponse(response, false, commandTimeout_, true);   // no "OK" -> complete after the line
+    int16_t pos = response.indexOf('V');
+    uint16_t version = 0;
+    if (pos >= 0)
+    {
+      for (uint16_t i = pos + 1; (i < response.length()) && (response[i] >= '0') && (response[i] <= '9'); i++) version = version * 10 + (response[i] - '0');
+    }
+    DebugBLE_print(F("firmware = ")); DebugBLE_println(version);
+    if (version == 0) return;   // keep the worst case
+
+    uint8_t i = 0;
+    while (pgm_read_word(&FIRMWARE_TABLE[i].version) > version) i++;   // the last entry matches any version
+    firmwareVersion_ = version;
+    unsupported_     = pgm_read_dword(&FIRMWARE_TABLE[i].unsupported);
+    commandTimeout_  = pgm_read_word(&FIRMWARE_TABLE[i].commandTimeout);
+    hwResetTime_     = pgm_read_word(&FIRMWARE_TABLE[i].hwResetTime);
+    swResetTime_     = pgm_read_word(&FIRMWARE_TABLE[i].swResetTime);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     recoverStep
+  * \brief  one step of the recovery ladder (see recover)
+  *
+  * \param  step   see enumerator in the header file
+  * \return true if the module responds afterwards
+  --------------------------------------------------------------------------- */
+  bool HM11::recoverStep(recoveryStep_t step)
+  {
+    switch (step)
+    {
+      case RECOVERY_PING:
+        /* the scan output would be mixed up with the response */
+        return !isScanning() && (isAlive() || isAlive());
+
+      case RECOVERY_RESYNC:
+        /* drop a half received response and the parser state */
+        scanState_ = SCAN_IDLE;
+        setModuleState(baseState_);
+#if HM11_FEATURE_CONNECTION
+        rxMatchPos_ = 0;
+        rxDataCount_ = 0;
+#endif
+        BLESerial_begin(baudrate_);
+        while(!BLESerial_ready());
+        BLE_delay(commandTimeout_);
+        while(BLESerial_available()) BLESerial_read();
+        return isAlive() || isAlive();
+
+      case RECOVERY_HW_RESET:
+#if HM11_FEATURE_CONNECTION
+        if (linkState_ != LINK_DISCONNECTED) notify(EVENT_LOST);   // the reset drops the link
+#endif
+        hwResetBLE();
+        return isAlive();
+
+      case RECOVERY_BAUDRATE:
+        return setBaudrate();
+
+#if HM11_FEATURE_RENEW
+      case RECOVERY_RENEW:
+      {
+        /* the module did not respond properly at any baudrate, try a RENEW at each of them */
+        baudrate_t baudratesArray[] = {BAUDRATE0, BAUDRATE1, BAUDRATE2, BAUDRATE3, BAUDRATE4};
+        for (uint8_t i = 0; i < sizeof(baudratesArray)/sizeof(baudrate_t); i++)
+        {
+          BLESerial_begin(baudratesArray[i]);
+          while(!BLESerial_ready());
+          if (setConf(CMD_RENEW, "", &NO_RETRY) == STATUS_OK)
+          {
+            invalidateShadow();
+            baseState_ = STATE_ADVERTISING;
+            setModuleState(STATE_RESETTING);
+            BLE_delay(swResetTime_);
+            setModuleState(baseState_);
+            return setBaudrate();
+          }
+        }
+        BLESerial_begin(baudrate_);
+        while(!BLESerial_ready());
+        return false;
+      }
+#endif
+
+      default: return false;
+    }
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setBaudrate
+  * \brief  sets baudrtae of the BLE module
+  *
+  * \param  baudrate  baudrate (see enumerator in the header file)
+  * \return true if it succeeded
+  --------------------------------------------------------------------------- */
+  bool HM11::setBaudrate(baudrate_t baudrate)
+  {
+    baudrate_ = baudrate;
+    return setBaudrate();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setBaudrate
+  * \brief  sets baudrtae of the BLE module
+  *
+  * \return true if it succeeded
+  --------------------------------------------------------------------------- */
+  bool HM11::setBaudrate()
+  {
+    bool successful = true;
+    uint32_t currentBaudrate = getBaudrate();
     DebugBLE_print(F("currentBaudrate = ")); DebugBLE_println(currentBaudrate);
     DebugBLE_println("");
 
@@ -764,18 +1908,22 @@
       {
         /* set baudrate */
         DebugBLE_println(F("set new baudrate..."));
+#if HM11_FEATURE_RENEW
         if (currentBaudrate != BAUDRATE0) renewBLE();
 
         BLESerial_begin(DEFAULT_BAUDRATE);
+#else
+        BLESerial_begin(currentBaudrate);   // switch directly without restoring the factory default
+#endif
         while(!BLESerial_ready());
 
         switch(baudrate_)
         {
-          case BAUDRATE0: setConf(F("BAUD0")); break;
-          case BAUDRATE1: setConf(F("BAUD1")); break;
-          case BAUDRATE2: setConf(F("BAUD2")); break;
-          case BAUDRATE3: setConf(F("BAUD3")); break;
-          case BAUDRATE4: setConf(F("BAUD4")); break;
+          case BAUDRATE0: setConf(CMD_BAUD, '0', &NO_RETRY); break;
+          case BAUDRATE1: setConf(CMD_BAUD, '1', &NO_RETRY); break;
+          case BAUDRATE2: setConf(CMD_BAUD, '2', &NO_RETRY); break;
+          case BAUDRATE3: setConf(CMD_BAUD, '3', &NO_RETRY); break;
+          case BAUDRATE4: setConf(CMD_BAUD, '4', &NO_RETRY); break;
           default: //handleError("invalid baudrate!");
           {
             DebugBLE_println(F("invalid baudrate!"));
@@ -789,7 +1937,8 @@
         while(!BLESerial_ready());
 
         /* check if setting the baudrate failed */
-        if (getConf(F("BAUD")).indexOf("OK") < 0) //handleError("set baudrate failed!");
+        String response;
+        if (getConf(CMD_BAUD, response) != STATUS_OK) //handleError("set baudrate failed!");
         {
           DebugBLE_println(F("set baudrate failed!"));
           successful = false;//while(1);
@@ -814,20 +1963,20 @@
     baudrate_t baudratesArray[] = {BAUDRATE0, BAUDRATE1, BAUDRATE2, BAUDRATE3, BAUDRATE4};
 
     uint8_t i;
-    String response = "";
-    for (i = 0; (response.indexOf("OK") < 0) && (i < sizeof(baudratesArray)/sizeof(baudrate_t)); i++)
+    bool alive = false;
+    for (i = 0; !alive && (i < sizeof(baudratesArray)/sizeof(baudrate_t)); i++)
     {
       DebugBLE_println(baudratesArray[i]);
       BLESerial_begin(baudratesArray[i]);
       while(!BLESerial_ready());
-      for (uint8_t n = 0; (n < 5) && (response.indexOf("OK") < 0); n++)
+      for (uint8_t n = 0; (n < 5) && !alive; n++)
       {
         /* try 5 times per baudrate */
-        response = sendDirectBLECommand(F("AT"));
+        alive = isAlive();
       }
     }
 
-    if (i >= sizeof(baudratesArray)/sizeof(baudrate_t))
+    if (!alive)
     {
       //handleError(F("determining the current baudrate of the BLE failed!"));
       DebugBLE_println(F("determining the baudrate failed!"));
@@ -838,65 +1987,679 @@
   }
 
 /** -------------------------------------------------------------------------
-  * \fn     sendDirectBLECommand
-  * \brief  sends a direct AT command to the BLE module
+  * \fn     sendCommand
+  * \brief  sends an AT command from the command table to the BLE module
   *
-  * \param  cmd       AT command
+  * \param  cmd       AT verb (see COMMAND_TABLE)
+  * \param  arg       argument which follows the verb
+  * \param  query     append a '?'
+  * \param  response  response of the BLE module as a string
   * \param  timeout   time in ms before timeout
-  * \return response of the BLE module as a string
+  * \return STATUS_OK if the module responded with "OK"
   --------------------------------------------------------------------------- */
-  String HM11::sendDirectBLECommand(String cmd, uint16_t timeout)
+  HM11::status_t HM11::sendCommand(command_t cmd, const char *arg, bool query, String &response, uint16_t timeout)
   {
-    bool failed = false;
-    String response = "";
-    response.reserve(DEFAULT_RESPONSE_LENGTH);
+    /* fail fast instead of waiting for the timeout */
+    if (unsupported_ & (uint32_t(1) << cmd)) return STATUS_UNSUPPORTED;
+    /* the scan output would be mixed up with the response */
+    if (isScanning()) return STATUS_BUSY;
+    if (timeout == 0) timeout = commandTimeout_;
+    writeCommand(cmd, arg, query);
+    /* wait for more data if the cmd has a '+' */
+    return readBLEResponse(response, cmd != CMD_AT, timeout);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     writeCommand
+  * \brief  writes "AT+<verb><arg>[?]" without building it in the RAM and
+  *         without waiting for a response
+  *
+  * \param  cmd    AT verb (see COMMAND_TABLE)
+  * \param  arg    argument which follows the verb
+  * \param  query  append a '?'
+  --------------------------------------------------------------------------- */
+  void HM11::writeCommand(command_t cmd, const char *arg, bool query)
+  {
+    static_assert(sizeof(COMMAND_TABLE) / sizeof(COMMAND_TABLE[0]) == CMD_COUNT, "COMMAND_TABLE does not match command_t!");
+    PGM_P verb = COMMAND_TABLE[cmd];
+    DebugBLE_print(F("send:\t\tAT+")); DebugBLE_print((const __FlashStringHelper *)verb); DebugBLE_println(arg);
+    BLESerial_write('A');
+    BLESerial_write('T');
+    if (cmd != CMD_AT) BLESerial_write('+');
+    for (char c = pgm_read_byte(verb); c != '\0'; c = pgm_read_byte(++verb)) BLESerial_write(c);
+    while (*arg != '\0') BLESerial_write(*arg++);
+    if (query) BLESerial_write('?');
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     sendDirectBLECommand_P
+  * \brief  sends a direct AT command from PROGMEM to the BLE module
+  *
+  * \param  cmd       AT command in PROGMEM
+  * \param  response  response of the BLE module as a string
+  * \param  timeout   time in ms before timeout
+  * \return STATUS_OK if the module responded with "OK"
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::sendDirectBLECommand_P(PGM_P cmd, String &response, uint16_t timeout)
+  {
+    if (isScanning()) return STATUS_BUSY;
+    if (timeout == 0) timeout = commandTimeout_;
     /* wait for more data if the cmd has a '+' */
     bool waitForMore = false;
-    if(cmd.indexOf("+") >= 0) waitForMore = true;
-    /* send command */
-    DebugBLE_print(F("send:\t\t")); DebugBLE_println(cmd);
-    BLESerial_print(cmd);
-    /* get response */
-    uint32_t startMillis_BLE = millis();
-    while ((response.indexOf("OK") < 0 || BLESerial_available() || waitForMore) && !failed)
-    {
-      if (BLESerial_available())
-      {
-        response.concat(char(BLESerial_read()));
-
-        /* special delay (necessary! -> wait some time to let the Serial buffer be filled) */
-        #ifdef DEBUG_BLE
-          //DebugBLE_print(F("got:\t\t")); DebugBLE_println(response);
-          delay(1); // >= 1ms
-        #else
-          delay(1); // >= 1ms
-        #endif
-      }
+    if (strchr_P(cmd, '+') != NULL) waitForMore = true;
+    /* send command byte by byte directly from the flash */
+    writeBLECommand_P(cmd);
+    return readBLEResponse(response, waitForMore, timeout);
+  }
 
-      /* stop waiting for more data if we got a '+' */
-      if (waitForMore && response.indexOf("+") >= 0) waitForMore = false;
+/** -------------------------------------------------------------------------
+  * \fn     writeBLECommand_P
+  * \brief  writes an AT command from PROGMEM without waiting for a response
+  *
+  * \param  cmd   AT command in PROGMEM
+  --------------------------------------------------------------------------- */
+  void HM11::writeBLECommand_P(PGM_P cmd)
+  {
+    /* send command byte by byte directly from the flash */
+    DebugBLE_print(F("send:\t\t")); DebugBLE_println((const __FlashStringHelper *)cmd);
+    for (char c = pgm_read_byte(cmd); c != '\0'; c = pgm_read_byte(++cmd)) BLESerial_write(c);
+  }
 
-      if ((millis() - startMillis_BLE) >= timeout)
+/** -------------------------------------------------------------------------
+  * \fn     readBLEResponse
+  * \brief  reads the response of the BLE module to a sent command
+  *
+  * \param  response      response of the BLE module as a string
+  * \param  waitForMore   wait until a '+' has been received
+  * \param  timeout       time in ms before timeout
+  * \param  anyResponse   the response has no "OK" (e.g. "AT+VERS?") -> complete
+  *                       with a line terminator or RESPONSE_GAP_TIME of silence
+  * \return STATUS_OK if the module responded with "OK", STATUS_TIMEOUT if
+  *         nothing was received, STATUS_BAD_RESPONSE if the response was
+  *         incomplete or unexpected, STATUS_NOT_CONNECTED on a failed link
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::readBLEResponse(String &response, bool waitForMore, uint16_t timeout, bool anyResponse)
+  {
+    bool failed = false;
+    response = "";
+    response.reserve(DEFAULT_RESPONSE_LENGTH);
+    /* get response, nothing terminates it -> it is complete after "OK" (and
+       the '+' if waiting for more) followed by RESPONSE_GAP_TIME of silence */
+    uint32_t startMillis_BLE = BLE_millis();
+    uint32_t lastByteMillis = startMillis_BLE;
+    bool complete = false;
+    while (true)
+    {
+      uint32_t ms = BLE_millis();
+      if (complete && (ms - lastByteMillis) >= RESPONSE_GAP_TIME) break;
+      if ((ms - startMillis_BLE) >= timeout)
+      {
+        failed = !complete;
+        if (failed) {DebugBLE_println(F("reading response timeouted!"));}
+        break;
+      }
+      uint16_t wait = complete ? RESPONSE_GAP_TIME - (ms - lastByteMillis) : timeout - (ms - startMillis_BLE);
+      if (BLESerial_wait(wait))
       {
-        failed = true;
-        response = "error";
-        DebugBLE_println(F("reading response timeouted!"));
+        char c = char(BLESerial_read());
+        response.concat(c);
+        lastByteMillis = BLE_millis();
+        if (anyResponse)
+        {
+          if (c == '\n') break;
+          complete = true;
+          continue;
+        }
+        /* stop waiting for more data if we got a '+' */
+        if (c == '+') waitForMore = false;
+        complete = !waitForMore && hasResponse(response, RSP_OK);
       }
     }
 
     /* print response */
     DebugBLE_print(F("received:\t")); DebugBLE_println(response);
-    DebugBLE_print(F("dt =\t\t")); DebugBLE_print(String(millis() - startMillis_BLE)); DebugBLE_println(F("ms"));
+    DebugBLE_print(F("dt =\t\t")); DebugBLE_print(String(BLE_millis() - startMillis_BLE)); DebugBLE_println(F("ms"));
     DebugBLE_println("");
 
+    commandCount_++;
+    commandTime_ += BLE_millis() - startMillis_BLE;
+
     BLESerial_flush();
 
     response.trim();
 
-    return response;
+    if (failed) return (response.length() == 0) ? STATUS_TIMEOUT : STATUS_BAD_RESPONSE;
+    if (hasResponse(response, RSP_CONNF) || hasResponse(response, RSP_CONNE) || hasResponse(response, RSP_LOST)) return STATUS_NOT_CONNECTED;
+    return STATUS_OK;
+  }
+
+#if HM11_FEATURE_DETECTOR
+/** -------------------------------------------------------------------------
+  * \fn     findIBeacon
+  * \brief  scans for iBeacons with the streaming parser and returns the data
+  *         of the first match, the scan runs until "OK+DISCE" or timeout
+  *
+  * \param  iBeacon           uuid (32 hex digits) and optionally major/minor to search for
+  * \param  maxTimeToSearch   max time to search for iBeacons in ms
+  * \param  matchVersion      major and minor have to match too
+  * \return true if an iBeacon was found
+  --------------------------------------------------------------------------- */
+  bool HM11::findIBeacon(iBeaconData_t *iBeacon, uint16_t maxTimeToSearch, bool matchVersion)
+  {
+    /* convert the uuid once instead of comparing strings */
+    uint8_t uuid[16];
+    if (iBeacon->uuid.length() != 32) return false;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+      char c = iBeacon->uuid[i];
+      if (!isHexCharacter(c)) return false;
+      uuid[i >> 1] = (i & 1) ? (uuid[i >> 1] | hexCharacterToNibble(c)) : (hexCharacterToNibble(c) << 4);
+    }
+    DebugBLE_print(F("uuidHex =\t")); DebugBLE_println(iBeacon->uuid);
+
+    if (!startIBeaconScan(maxTimeToSearch)) return false;
+
+    bool match = false;
+    iBeaconRecord_t record;
+    scanState_t state;
+    while ((state = pollIBeaconScan(&record)) == SCAN_RUNNING || state == SCAN_RECORD)
+    {
+      if (state != SCAN_RECORD || match) continue;
+      if (memcmp(record.uuid, uuid, sizeof(uuid)) != 0) continue;
+      if (matchVersion && (record.major != iBeacon->major || record.minor != iBeacon->minor)) continue;
+
+      DebugBLE_println(F("match!"));
+      match = true;
+      iBeacon->accessAddress = "";
+      for (int8_t shift = 24; shift >= 0; shift -= 8) iBeacon->accessAddress += byteToHexString(uint8_t(record.accessAddress >> shift));
+      iBeacon->deviceAddress = "";
+      for (uint8_t i = 0; i < sizeof(record.mac); i++) iBeacon->deviceAddress += byteToHexString(record.mac[i]);
+      iBeacon->major   = record.major;
+      iBeacon->minor   = record.minor;
+      iBeacon->txPower = record.rssi;
+    }
+    if (!match) {DebugBLE_println(F("no match"));}
+    DebugBLE_print(F("getFreeRAM() = ")); DebugBLE_println(getFreeRAM());
+
+    return match;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     startScan
+  * \brief  sends the scan command without waiting for the response
+  *
+  * \param  cmd               scan command (CMD_DISI or CMD_DISC)
+  * \param  maxTimeToSearch   max time to search in ms
+  * \return true if the scan has been started
+  --------------------------------------------------------------------------- */
+  bool HM11::startScan(command_t cmd, uint16_t maxTimeToSearch)
+  {
+    static_assert(2 * sizeof(iBeaconRecord_t) + 16 + sizeof(deviceRecord_t) + sizeof(discTag_) <= HM11_SCAN_MEMORY_BUDGET,
+      "the scan path exceeds HM11_SCAN_MEMORY_BUDGET!");  // parser records + record and uuid of findIBeacon
+    if (isScanning() || (unsupported_ & (uint32_t(1) << cmd))) return false;
+#if HM11_FEATURE_CONNECTION
+    if (linkState_ != LINK_DISCONNECTED) return false;   // the command would be sent to the peer as data
+#endif
+
+    BLESerial_flush();
+    while(BLESerial_available()) BLESerial_read();  // drop old data
+    writeCommand(cmd, "", true);
+    commandCount_++;
+
+    scanState_ = SCAN_RUNNING;
+    setModuleState(STATE_SCANNING);
+    scanPos_ = 0;
+    scanTimeout_ = maxTimeToSearch;
+    scanStartMillis_ = BLE_millis();
+    return true;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     parseDiscoveryCharacter
+  * \brief  parses one character of the discovery response into discRecord_
+  *
+  * \param  c       received character
+  * \param  record  gets the previous device when a new one starts
+  * \return SCAN_RECORD if record has been filled, SCAN_DONE on "OK+DISCE"
+  *         otherwise SCAN_RUNNING
+  *
+  * Format: OK+DISCS OK+DIS0:001122334455[OK+RSSI:-080][OK+NAME:HMSoft\r\n] ... OK+DISCE
+  --------------------------------------------------------------------------- */
+  HM11::scanState_t HM11::parseDiscoveryCharacter(char c, deviceRecord_t *record)
+  {
+    switch (discState_)
+    {
+      case DISC_MAC:
+        if (isHexCharacter(c))
+        {
+          uint8_t i = discPos_ >> 1;
+          uint8_t nibble = hexCharacterToNibble(c);
+          discRecord_.mac[i] = (discPos_ & 1) ? (discRecord_.mac[i] | nibble) : (nibble << 4);
+          if (++discPos_ == 12)
+          {
+            discPending_ = true;
+            discState_ = DISC_PREFIX;
+            discPos_ = 0;
+          }
+          return SCAN_RUNNING;
+        }
+        discState_ = DISC_PREFIX;   // invalid -> resync
+        discPos_ = 0;
+        break;
+
+      case DISC_RSSI:
+        if (discPos_ == 0 && c == '-') {discPos_++; return SCAN_RUNNING;}
+        if (c >= '0' && c <= '9' && discPos_ < 4)
+        {
+          discRecord_.rssi = discRecord_.rssi * 10 - (c - '0');
+          discPos_++;
+          return SCAN_RUNNING;
+        }
+        discState_ = DISC_PREFIX;   // end of the number -> c belongs to the next line
+        discPos_ = 0;
+        break;
+
+      case DISC_NAME:
+        if (c == '\r' || c == '\n')
+        {
+          /* the name is the last detail of a device */
+          discState_ = DISC_PREFIX;
+          discPos_ = 0;
+          if (!discPending_) return SCAN_RUNNING;
+          *record = discRecord_;
+          discPending_ = false;
+          return SCAN_RECORD;
+        }
+        if (discPos_ < sizeof(discRecord_.name) - 1)   // longer names get truncated
+        {
+          discRecord_.name[discPos_++] = c;
+          discRecord_.name[discPos_] = '\0';
+        }
+        return SCAN_RUNNING;
+
+      case DISC_TAG:
+        if (c == ':')
+        {
+          discState_ = DISC_PREFIX;
+          if (discPos_ == 4 && strncmp_P(discTag_, PSTR("DIS"), 3) == 0)
+          {
+            /* a new device -> hand out the previous one */
+            scanState_t state = SCAN_RUNNING;
+            if (discPending_)
+            {
+              *record = discRecord_;
+              state = SCAN_RECORD;
+            }
+            memset(&discRecord_, 0, sizeof(discRecord_));
+            discPending_ = false;
+            discState_ = DISC_MAC;
+            discPos_ = 0;
+            return state;
+          }
+          if (discPos_ == 4 && strncmp_P(discTag_, PSTR("RSSI"), 4) == 0) {discRecord_.rssi = 0; discState_ = DISC_RSSI;}
+          if (discPos_ == 4 && strncmp_P(discTag_, PSTR("NAME"), 4) == 0) discState_ = DISC_NAME;
+          discPos_ = 0;
+          return SCAN_RUNNING;
+        }
+        if (discPos_ < sizeof(discTag_) && c >= '0' && c <= 'Z')
+        {
+          discTag_[discPos_++] = c;
+          if (discPos_ == 5 && strncmp_P(discTag_, PSTR("DISCE"), 5) == 0) {discState_ = DISC_PREFIX; discPos_ = 0; return SCAN_DONE;}
+          if (discPos_ == 5 && strncmp_P(discTag_, PSTR("DISCS"), 5) == 0) {discState_ = DISC_PREFIX; discPos_ = 0;}
+          return SCAN_RUNNING;
+        }
+        discState_ = DISC_PREFIX;   // unknown -> resync
+        discPos_ = 0;
+        break;
+
+      default: break;
+    }
+
+    /* DISC_PREFIX: "OK+" */
+    if (c == char(pgm_read_byte(&SCAN_PREFIX[discPos_])))
+    {
+      if (++discPos_ == 3) {discState_ = DISC_TAG; discPos_ = 0;}
+    }
+    else discPos_ = (c == 'O') ? 1 : 0;
+    return SCAN_RUNNING;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     parseScanCharacter
+  * \brief  parses one character of the scan response into scanRecord_
+  *
+  * \param  c   received character
+  * \return SCAN_RECORD if scanRecord_ is complete, SCAN_DONE on "OK+DISCE"
+  *         otherwise SCAN_RUNNING
+  *
+  * Line format (78 characters):
+  * OK+DISC:4C000215:00D7D3EE02E4470E97DA78CFAC4027CC:00C80007BA:000780031354:-071
+  * 0       8        17                               50  54  58 61           74
+  --------------------------------------------------------------------------- */
+  HM11::scanState_t HM11::parseScanCharacter(char c)
+  {
+    uint8_t pos = scanPos_++;
+    bool valid = true;
+
+    if (pos < 6) valid = (c == char(pgm_read_byte(&SCAN_PREFIX[pos])));   // "OK+DIS"
+    else if (pos == 6) valid = (c == 'C' || c == 'I');
+    else if (pos == 7)
+    {
+      if (c == 'E') {scanPos_ = 0; return SCAN_DONE;}   // "OK+DISCE"
+      if (c == 'S') {scanPos_ = 0; return SCAN_RUNNING;} // "OK+DISIS"
+      valid = (c == ':');
+    }
+    else if (pos == 16 || pos == 49 || pos == 60 || pos == 73) valid = (c == ':');
+    else if (pos < 16)  // company id and iBeacon type
+    {
+      valid = isHexCharacter(c);
+      scanRecord_.accessAddress = (pos == 8) ? hexCharacterToNibble(c) : ((scanRecord_.accessAddress << 4) | hexCharacterToNibble(c));
+    }
+    else if (pos < 74) // hex fields
+    {
+      valid = isHexCharacter(c);
+      uint8_t nibble = hexCharacterToNibble(c);
+      if (pos < 49)
+      {
+        uint8_t i = (pos - 17) >> 1;
+        scanRecord_.uuid[i] = ((pos - 17) & 1) ? (scanRecord_.uuid[i] | nibble) : (nibble << 4);
+      }
+      else if (pos < 54) scanRecord_.major = (pos == 50) ? nibble : ((scanRecord_.major << 4) | nibble);
+      else if (pos < 58) scanRecord_.minor = (pos == 54) ? nibble : ((scanRecord_.minor << 4) | nibble);
+      else if (pos < 60) scanRecord_.measuredPower = (pos == 58) ? (nibble << 4) : (scanRecord_.measuredPower | nibble);
+      else
+      {
+        uint8_t i = (pos - 61) >> 1;
+        scanRecord_.mac[i] = ((pos - 61) & 1) ? (scanRecord_.mac[i] | nibble) : (nibble << 4);
+      }
+    }
+    else if (pos == 74) {valid = (c == '-'); scanRecord_.rssi = 0;}
+    else  // rssi digits
+    {
+      valid = (c >= '0' && c <= '9');
+      scanRecord_.rssi = scanRecord_.rssi * 10 - (c - '0');
+      if (valid && pos == 77)
+      {
+        scanPos_ = 0;
+        return SCAN_RECORD;
+      }
+    }
+
+    /* resync on the next "OK+DIS" */
+    if (!valid) scanPos_ = (c == 'O') ? 1 : 0;
+    return SCAN_RUNNING;
+  }
+#endif
+
+/** -------------------------------------------------------------------------
+  * \fn     BLESerial_wait
+  * \brief  default: checks for received data without waiting, backends
+  *         with a blocking wait (e.g. poll) override this
+  *
+  * \param  timeout   max time to wait in ms
+  * \return true if data is available
+  --------------------------------------------------------------------------- */
+  bool HM11::BLESerial_wait(uint16_t timeout)
+  {
+    (void)timeout;
+    return BLESerial_available() > 0;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     BLE_millis
+  * \brief  time base of the library (default: Arduino millis())
+  *
+  * \return time in ms
+  --------------------------------------------------------------------------- */
+  uint32_t HM11::BLE_millis()
+  {
+    return millis();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     BLE_delay
+  * \brief  delay of the library (default: Arduino delay())
+  *
+  * \param  ms   time in ms
+  --------------------------------------------------------------------------- */
+  void HM11::BLE_delay(uint32_t ms)
+  {
+    delay(ms);
+  }
+
+#if HM11_FEATURE_CONNECTION
+/** -------------------------------------------------------------------------
+  * \fn     demuxCharacter
+  * \brief  streaming demultiplexer of the module notifications ("OK+CONN",
+  *         "OK+LOST", "OK+WAKE") in the received data, the notifications
+  *         update the link state and get dispatched, all other characters
+  *         are application data (collected only for readData)
+  *
+  * \param  c   received character
+  --------------------------------------------------------------------------- */
+  void HM11::demuxCharacter(char c)
+  {
+    /* the character after "OK+CONN" decides: A = accepted, F/E = failed */
+    if (rxMatchPos_ == 7)
+    {
+      rxMatchPos_ = 0;
+      if (c == 'A') {linkState_ = LINK_CONNECTING; return;}
+      if (c == 'F' || c == 'E') {notify(EVENT_CONNECT_FAILED); return;}
+      notify(EVENT_CONNECTED);
+    }
+
+    /* all notifications are "OK+" + 4 characters, the 4th selects it */
+    uint8_t pos = rxMatchPos_;
+    if (pos == 3) rxMatch_ = (c == 'C') ? RSP_CONN : (c == 'L') ? RSP_LOST : RSP_WAKE;
+    if (c == char(pgm_read_byte(&RESPONSE_TABLE[rxMatch_][pos])))
+    {
+      if (++rxMatchPos_ < 7 || rxMatch_ == RSP_CONN) return;   // "OK+CONN" -> decided by the next character
+      rxMatchPos_ = 0;
+      notify((rxMatch_ == RSP_LOST) ? EVENT_LOST : EVENT_WAKE);
+      return;
+    }
+    if (pos == 0) {pushData(c); return;}
+
+    /* mismatch -> the first held character is data, the rest is matched again */
+    response_t held = rxMatch_;
+    rxMatchPos_ = 0;
+    pushData('O');
+    for (uint8_t i = 1; i < pos; i++) demuxCharacter(char(pgm_read_byte(&RESPONSE_TABLE[held][i])));
+    demuxCharacter(c);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     startConnect
+  * \brief  sets the role up and sends "AT+CON" to the last peer without
+  *         waiting for the link (see connectToMacAddress, pollConnection)
+  *
+  * \return STATUS_OK if the command has been sent
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11::startConnect()
+  {
+    status_t status = setRole(lastPeerMaster_);
+    if (status != STATUS_OK) return status;
+
+    DebugBLE_print(F("connect to ")); DebugBLE_println(lastPeer_);
+    while(BLESerial_available()) BLESerial_read();
+    writeCommand(CMD_CON, lastPeer_, false);
+    commandCount_++;
+    linkState_ = LINK_CONNECTING;
+    rxMatchPos_ = 0;
+    connectStartMillis_ = BLE_millis();
+    rxLastMillis_ = connectStartMillis_;
+    return STATUS_OK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     cancelConnect
+  * \brief  gives up a connecting which timed out, the "AT" cancels it (the
+  *         "OK" is not waited for)
+  --------------------------------------------------------------------------- */
+  void HM11::cancelConnect()
+  {
+    linkState_ = LINK_DISCONNECTED;
+    rxMatchPos_ = 0;
+    linkStats_.failures++;
+    setModuleState(baseState_);
+    writeCommand(CMD_AT, "", false);
+    commandCount_++;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     settleNotification
+  * \brief  decides a held notification after CONN_SETTLE_TIME of silence
+  *         since the last received character (rxLastMillis_): "OK+CONN" is
+  *         complete (no A/F/E follows), anything else was data
+  --------------------------------------------------------------------------- */
+  void HM11::settleNotification()
+  {
+    if (rxMatchPos_ == 0 || (BLE_millis() - rxLastMillis_) < CONN_SETTLE_TIME) return;
+    uint8_t pos = rxMatchPos_;
+    rxMatchPos_ = 0;
+    if (pos == 7 && rxMatch_ == RSP_CONN) notify(EVENT_CONNECTED);
+    else for (uint8_t i = 0; i < pos; i++) pushData(char(pgm_read_byte(&RESPONSE_TABLE[rxMatch_][i])));
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     pushData
+  * \brief  hands a character of the application data over to readData
+  *
+  * \param  c   received character
+  --------------------------------------------------------------------------- */
+  void HM11::pushData(char c)
+  {
+    if (!rxCollect_ || rxDataCount_ >= RX_DATA_SIZE) return;
+    rxData_[(rxDataHead_ + rxDataCount_) & (RX_DATA_SIZE - 1)] = uint8_t(c);
+    rxDataCount_++;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     notify
+  * \brief  updates the link state and the stats with a module notification
+  *         and calls the event callback
+  *
+  * \param  event   see enumerator in the header file
+  --------------------------------------------------------------------------- */
+  void HM11::notify(event_t event)
+  {
+    switch (event)
+    {
+      case EVENT_CONNECTED:
+        linkConnected();
+        break;
+      case EVENT_CONNECT_FAILED:
+        DebugBLE_println(F("connecting failed!"));
+        linkState_ = LINK_DISCONNECTED;
+        linkStats_.failures++;
+        setModuleState(baseState_);
+        break;
+      case EVENT_LOST:
+        DebugBLE_println(F("link lost!"));
+        if (linkState_ == LINK_CONNECTED) linkStats_.drops++;
+        linkState_ = LINK_DISCONNECTED;
+        lastDropMillis_ = BLE_millis();
+        reconnectBackoff_ = MIN_RECONNECT_BACKOFF;
+        setModuleState(baseState_);
+        break;
+      case EVENT_WAKE:
+        setModuleState(baseState_);
+        break;
+      default: break;
+    }
+    if (eventCallback_ != NULL) eventCallback_(event, eventContext_);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     linkConnected
+  * \brief  the link is up ("OK+CONN" without A/F/E) -> updates the stats
+  --------------------------------------------------------------------------- */
+  void HM11::linkConnected()
+  {
+    if (linkState_ == LINK_CONNECTING)
+    {
+      uint16_t latency = BLE_millis() - connectStartMillis_;
+      linkStats_.lastLatency = latency;
+      linkStats_.latencySum += latency;
+      if (latency > linkStats_.maxLatency) linkStats_.maxLatency = latency;
+    }
+    DebugBLE_println(F("connected!"));
+    reconnecting_ = false;
+    reconnectBackoff_ = MIN_RECONNECT_BACKOFF;
+    linkStats_.connects++;
+    linkState_ = LINK_CONNECTED;
+    setModuleState(STATE_CONNECTED);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     txQueued
+  * \brief  returns the number of bytes in the TX queue
+  *
+  * \return number of bytes
+  --------------------------------------------------------------------------- */
+  uint16_t HM11::txQueued()
+  {
+    return uint16_t(txHead_ - txTail_);
+  }
+#endif
+
+#ifdef HM11_RAM_PROFILING
+/** -------------------------------------------------------------------------
+  * \fn     RAMProbe
+  * \brief  paints the free RAM between heap and stack with a canary at the
+  *         beginning of the outermost public API call
+  *
+  * \param  ble  instance which gets the measurement
+  * \param  api  measured public API call
+  --------------------------------------------------------------------------- */
+  HM11::RAMProbe::RAMProbe(HM11 *ble, api_t api) :
+    ble_(ble), api_(api), bottom_(NULL), top_(NULL)
+  {
+    if (ble_->probeDepth_++ > 0) return;  // nested call -> measured by the outer one
+  #ifdef __AVR__
+    extern int16_t __heap_start, *__brkval;
+    uint8_t marker;
+    bottom_ = (uint8_t *)((__brkval == 0) ? &__heap_start : __brkval);
+    top_ = &marker - RAM_PROBE_MARGIN;
+    for (uint8_t *p = bottom_; p < top_; p++) *p = RAM_CANARY;
+  #endif
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     ~RAMProbe
+  * \brief  searches the untouched canary area and updates the peak usage
+  --------------------------------------------------------------------------- */
+  HM11::RAMProbe::~RAMProbe()
+  {
+    if (--ble_->probeDepth_ > 0 || top_ == NULL) return;
+
+    uint8_t *heapEnd = bottom_;
+    while (heapEnd < top_ && *heapEnd != RAM_CANARY) heapEnd++;     // the heap grows up
+    uint8_t *stackEnd = top_;
+    while (stackEnd > heapEnd && *(stackEnd - 1) != RAM_CANARY) stackEnd--;  // the stack grows down
+
+    ramUsage_t *usage = &ble_->ramUsage_[api_];
+    uint16_t heap = heapEnd - bottom_;
+    uint16_t stack = (top_ + RAM_PROBE_MARGIN) - stackEnd;
+    if (heap > usage->heap) usage->heap = heap;
+    if (stack > usage->stack) usage->stack = stack;
   }
+#endif
 
 /* ======================= Private class Functions ========================== */
+/** -------------------------------------------------------------------------
+  * \fn     hasResponse
+  * \brief  checks if the response contains a response of the table
+  *
+  * \param  response  received response
+  * \param  rsp       expected response (see RESPONSE_TABLE)
+  * \return true if it is contained
+  --------------------------------------------------------------------------- */
+  bool HM11::hasResponse(const String &response, response_t rsp)
+  {
+    return strstr_P(response.c_str(), RESPONSE_TABLE[rsp]) != NULL;
+  }
+
 /** -------------------------------------------------------------------------
   * \fn     getFreeRAM
   * \brief  returns the size in bytes between the heap and the stack
@@ -905,9 +2668,13 @@
   --------------------------------------------------------------------------- */
   int16_t HM11::getFreeRAM()
   {
+  #ifdef __AVR__
     extern int16_t __heap_start, *__brkval;
     int16_t v;
     return (int16_t) &v - (__brkval == 0 ? (int16_t) &__heap_start : (int16_t) __brkval);
+  #else
+    return INT16_MAX;   // no heap/stack collision on hosts
+  #endif
   }
 
 /** -------------------------------------------------------------------------
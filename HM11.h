@@ -40,9 +40,47 @@
 #include <Arduino.h>
 
 /* ==================== Global module constant declaration ================== */
+/* RAM of the streaming scan path (records and parser state) in bytes, checked at compile time */
+#ifndef HM11_SCAN_MEMORY_BUDGET
+  #define HM11_SCAN_MEMORY_BUDGET  128
+#endif
+
+/* TX queue of the connected link in bytes (power of two), see write() */
+#ifndef HM11_TX_BUFFER_SIZE
+  #define HM11_TX_BUFFER_SIZE  64
+#endif
+
+/* define to record the peak stack and heap usage of the public API calls, see
+   getRAMUsage() (paints the free RAM with a canary -> ~1ms per call, AVR only) */
+//#define HM11_RAM_PROFILING
+
+/* feature gates -> set to 0 (as build flag, e.g. -DHM11_FEATURE_HANDSHAKING=0,
+   so the header and HM11.cpp agree) to strip the feature from the flash,
+   extras/size.sh measures the footprint per configuration with avr-size */
+#ifndef HM11_FEATURE_DETECTOR
+  #define HM11_FEATURE_DETECTOR     1   // iBeacon detector, scan and discovery
+#endif
+#ifndef HM11_FEATURE_CONNECTION
+  #define HM11_FEATURE_CONNECTION   1   // connect, link state tracking and auto reconnect
+#endif
+#ifndef HM11_FEATURE_HANDSHAKING
+  #define HM11_FEATURE_HANDSHAKING  1
+#endif
+#ifndef HM11_FEATURE_RENEW
+  #define HM11_FEATURE_RENEW        1   // restore factory default (begin(), last step of recover())
+#endif
+#ifndef HM11_FEATURE_ENERGY
+  #define HM11_FEATURE_ENERGY       1   // time per module state and charge estimate
+#endif
 
 /* ========================= Global macro declaration ======================= */
-/* port manipulation makros */
+/* port manipulation makros (on hosts the ports are plain shadow bytes) */
+#ifndef _SFR_BYTE
+  #define _SFR_BYTE(sfr) (sfr)
+#endif
+#ifndef _BV
+  #define _BV(bit) (1 << (bit))
+#endif
 #ifndef clearBit
   #define clearBit(reg, bit) (_SFR_BYTE(reg) &= ~_BV(bit))
 #endif
@@ -56,7 +94,46 @@
   #define getBit(reg, bit) ((_SFR_BYTE(reg) & _BV(bit)) != 0)
 #endif
 
+/* iBeacon profile which is validated and converted to AT commands at compile time
+   Example (at file scope):
+   HM11_IBEACON_PROFILE(myBeacon, "HMSoft", "74278BDAB64445208F0C720EAF059935",
+     1, 2, HM11::INTERV_100MS, HM11::POWER_0DBM);
+   BLE.setupAsIBeacon(&myBeacon); */
+#define HM11_IBEACON_PROFILE(profile, name, uuid, major, minor, interv, power) \
+  static_assert(sizeof(name) - 1 <= 12, "iBeacon name is too long!"); \
+  static_assert(HM11::isValidUUID(uuid), "iBeacon UUID has to be 32 upper case hex digits!"); \
+  static_assert((major) > 0 && (major) < 0xFFFE, "major have to be between 0 and 65'534!"); \
+  static_assert((minor) > 0 && (minor) < 0xFFFE, "minor have to be between 0 and 65'534!"); \
+  static_assert(uint8_t(interv) <= HM11::INTERV_1285MS, "unallowed interval!"); \
+  static_assert(uint8_t(power) <= HM11::POWER_6DBM, "unallowed tx power!"); \
+  const HM11::iBeaconProfile_t profile PROGMEM = \
+  { \
+    HM11_IBEACON_HEX_COMMAND('M', 'A', 'R', 'J', major), \
+    HM11_IBEACON_HEX_COMMAND('M', 'I', 'N', 'O', minor), \
+    { \
+      HM11_IBEACON_UUID_COMMAND('0', uuid, 0), \
+      HM11_IBEACON_UUID_COMMAND('1', uuid, 8), \
+      HM11_IBEACON_UUID_COMMAND('2', uuid, 16), \
+      HM11_IBEACON_UUID_COMMAND('3', uuid, 24) \
+    }, \
+    "AT+NAME" name, \
+    {'A', 'T', '+', 'A', 'D', 'V', 'I', char('0' + uint8_t(interv)), '\0'}, \
+    {'A', 'T', '+', 'P', 'O', 'W', 'E', char('0' + uint8_t(power)), '\0'} \
+  }
+
+/* helper makros of HM11_IBEACON_PROFILE() */
+#define HM11_IBEACON_HEX_COMMAND(c0, c1, c2, c3, value) \
+  {'A', 'T', '+', c0, c1, c2, c3, '0', 'x', \
+   HM11::toHexCharacter(value, 12), HM11::toHexCharacter(value, 8), \
+   HM11::toHexCharacter(value, 4), HM11::toHexCharacter(value, 0), '\0'}
+#define HM11_IBEACON_UUID_COMMAND(n, uuid, i) \
+  {'A', 'T', '+', 'I', 'B', 'E', n, \
+   (uuid)[i], (uuid)[i + 1], (uuid)[i + 2], (uuid)[i + 3], \
+   (uuid)[i + 4], (uuid)[i + 5], (uuid)[i + 6], (uuid)[i + 7], '\0'}
+
 /* ============================ Class declaration =========================== */
+static_assert((HM11_TX_BUFFER_SIZE & (HM11_TX_BUFFER_SIZE - 1)) == 0, "HM11_TX_BUFFER_SIZE has to be a power of two!");
+
 class HM11
 {
 public:
@@ -92,6 +169,103 @@ public:
     POWER_6DBM    = 3
   } txPower_t;
 
+  typedef enum : uint8_t
+  {
+    STATUS_OK             = 0,
+    STATUS_TIMEOUT        = 1,  // no response -> transient, gets retried
+    STATUS_BAD_RESPONSE   = 2,  // unexpected response
+    STATUS_BUSY           = 3,  // module is busy (e.g. scanning)
+    STATUS_NOT_CONNECTED  = 4,  // connecting failed or link lost
+    STATUS_INVALID        = 5,  // invalid parameter
+    STATUS_UNSUPPORTED    = 6   // the firmware lacks the command (not sent)
+  } status_t;
+
+  typedef struct
+  {
+    uint8_t retries;           // max. retries after a timeout
+    uint16_t backoff;          // first backoff in ms (doubled with every retry)
+    uint16_t maxBackoff;       // in ms
+  } retryPolicy_t;
+
+  typedef enum : uint8_t
+  {
+    LINK_DISCONNECTED = 0,
+    LINK_CONNECTING   = 1,  // "AT+CON" sent, waiting for "OK+CONN"
+    LINK_CONNECTED    = 2
+  } linkState_t;
+
+  typedef enum : uint8_t
+  {
+    EVENT_CONNECTED       = 0,  // "OK+CONN"
+    EVENT_CONNECT_FAILED  = 1,  // "OK+CONNF" or "OK+CONNE"
+    EVENT_LOST            = 2,  // "OK+LOST"
+    EVENT_WAKE            = 3   // "OK+WAKE"
+  } event_t;
+
+  typedef void (*eventCallback_t)(event_t event, void *context);
+
+  typedef struct
+  {
+    uint16_t connects;         // successful connects
+    uint16_t failures;         // failed connects
+    uint16_t drops;            // "OK+LOST"
+    uint16_t lastLatency;      // in ms ("AT+CON" -> "OK+CONN")
+    uint16_t maxLatency;       // in ms
+    uint32_t latencySum;       // in ms
+  } linkStats_t;
+
+  typedef struct
+  {
+    uint32_t writes;           // accepted write() calls
+    uint32_t packets;          // BLE packets handed to the module (one burst each)
+    uint32_t uncoalescedPackets;  // packets the writes would have needed on their own
+    uint32_t airTimeSaved;     // in us, estimated packet overhead saved by coalescing
+  } txStats_t;
+
+  typedef enum : uint8_t
+  {
+    STATE_DISABLED    = 0,  // disable()
+    STATE_IDLE        = 1,  // central, waiting for AT commands
+    STATE_ADVERTISING = 2,  // peripheral or iBeacon
+    STATE_SCANNING    = 3,
+    STATE_CONNECTED   = 4,
+    STATE_RESETTING   = 5,  // HW reset, AT+RESET, AT+RENEW
+    STATE_SLEEPING    = 6,  // sleepBLE()
+    STATE_COUNT       = 7
+  } moduleState_t;
+
+  typedef struct
+  {
+    uint16_t current[STATE_COUNT];  // in uA per moduleState_t
+  } currentProfile_t;
+
+  typedef enum : uint8_t
+  {
+    RECOVERY_PING     = 0,  // the module responded to "AT" right away
+    RECOVERY_RESYNC   = 1,  // after flushing the UART and the parser state
+    RECOVERY_HW_RESET = 2,  // after a HW reset
+    RECOVERY_BAUDRATE = 3,  // after detecting and restoring the baudrate
+    RECOVERY_RENEW    = 4,  // after restoring the factory default
+    RECOVERY_FAILED   = 5
+  } recoveryStep_t;
+
+  typedef struct
+  {
+    recoveryStep_t lastStep;   // step of the last recover() call
+    uint16_t lastDuration;     // in ms
+    uint16_t maxDuration;      // in ms
+    uint16_t steps[RECOVERY_FAILED + 1];  // recover() calls per step
+  } recoveryStats_t;
+
+  typedef struct
+  {
+    uint16_t updates;          // updateTelemetry() calls which changed a value
+    uint16_t commands;         // AT commands sent for them (1 or 2 per update)
+    uint16_t lastAckLatency;   // in ms (call -> last command acknowledged, not until on air)
+    uint16_t maxAckLatency;    // in ms
+    uint32_t ackLatencySum;    // in ms
+  } telemetryStats_t;
+
   typedef struct
   {
     String name;               // 12 bytes
@@ -104,6 +278,70 @@ public:
     int16_t txPower;           // 2 bytes
   } iBeaconData_t;
 
+  typedef struct
+  {
+    char marj[14];             // "AT+MARJ0x" + 4 hex digits
+    char mino[14];             // "AT+MINO0x" + 4 hex digits
+    char ibe[4][16];           // "AT+IBEn" + 8 hex digits of the UUID
+    char name[20];             // "AT+NAME" + max. 12 characters
+    char advi[9];              // "AT+ADVI" + interval digit
+    char powe[9];              // "AT+POWE" + power digit
+  } iBeaconProfile_t;          // complete AT commands, see HM11_IBEACON_PROFILE()
+
+  typedef struct
+  {
+    uint8_t uuid[16];          // 16 bytes
+    uint8_t mac[6];            // 6 bytes
+    uint16_t major;            // 2 bytes
+    uint16_t minor;            // 2 bytes
+    uint32_t accessAddress;    // 4 bytes -> company id and iBeacon type (e.g. 0x4C000215)
+    int8_t measuredPower;      // 1 byte -> RSSI at 1m advertised by the iBeacon
+    int8_t rssi;               // 1 byte -> in dBm
+  } iBeaconRecord_t;           // binary representation of one "OK+DISC:" line
+
+  typedef struct
+  {
+    uint8_t mac[6];            // 6 bytes
+    int8_t rssi;               // 1 byte -> in dBm, 0 if not reported
+    char name[13];             // 13 bytes -> "" if not reported
+  } deviceRecord_t;            // one device of the generic discovery
+
+  typedef enum : uint8_t
+  {
+    SCAN_IDLE     = 0,  // no scan running
+    SCAN_RUNNING  = 1,  // scan is running, no new record
+    SCAN_RECORD   = 2,  // a new record has been received
+    SCAN_DONE     = 3,  // scan finished ("OK+DISCE")
+    SCAN_FAILED   = 4   // scan timeouted
+  } scanState_t;
+
+  typedef enum : uint8_t
+  {
+    API_BEGIN               = 0,
+    API_SET_TX_POWER        = 1,
+    API_GET_TX_POWER        = 2,
+    API_SETUP_AS_IBEACON    = 3,
+    API_SETUP_AS_DETECTOR   = 4,
+    API_DETECT_IBEACON      = 5,  // detectIBeacon and detectIBeaconUUID
+    API_START_SCAN          = 6,  // startIBeaconScan and startDiscovery
+    API_POLL_SCAN           = 7,  // pollIBeaconScan and pollDiscovery
+    API_GET_MAC_ADDRESS     = 8,
+    API_CONNECT             = 9,
+    API_POLL_CONNECTION     = 10,
+    API_PIO                 = 11,
+    API_HANDSHAKING         = 12,
+    API_RECOVER             = 13,
+    API_UPDATE_TELEMETRY    = 14,
+    API_SLEEP               = 15,  // sleepBLE and wakeUpBLE
+    API_COUNT               = 16
+  } api_t;
+
+  typedef struct
+  {
+    uint16_t stack;            // peak stack usage in bytes
+    uint16_t heap;             // peak heap growth in bytes
+  } ramUsage_t;
+
   /* Public member data */
   //...
 
@@ -116,7 +354,7 @@ public:
     txdPort_(txdPort), txd_(txd),
     enPort_(enPort), enPin_(enPin),
     rstPort_(rstPort), rstPin_(rstPin) {};
-  ~HM11() {};
+  virtual ~HM11() {};  // backends may be deleted through a base pointer
 
   /* Public member functions */
   bool begin(uint32_t baudrate = uint32_t(DEFAULT_BAUDRATE));
@@ -124,10 +362,15 @@ public:
   void enable();
   void disable();
   bool isEnabled();
-  void setTxPower(txPower_t txPower);
-  txPower_t getTxPower();
-  void setupAsIBeacon(iBeaconData_t *iBeacon);  // necessaray: name, uuid, major, minor, interv
-  void setupAsIBeaconDetector();
+  void setRetryPolicy(const retryPolicy_t *policy);
+  status_t setTxPower(txPower_t txPower);
+  status_t getTxPower(txPower_t &txPower);
+  status_t setupAsIBeacon(iBeaconData_t *iBeacon);  // necessaray: name, uuid, major, minor, interv
+  status_t setupAsIBeacon(const iBeaconProfile_t *profile);  // profile has to be located in PROGMEM
+  status_t updateTelemetry(uint16_t major, uint16_t minor);  // e.g. sensor readings, several times a second (after setupAsIBeacon)
+  const telemetryStats_t *getTelemetryStats();
+#if HM11_FEATURE_DETECTOR
+  status_t setupAsIBeaconDetector();
   bool detectIBeacon(iBeaconData_t *iBeacon, uint16_t maxTimeToSearch = DEFAULT_DETECTION_TIME);      // necessary: uuid, major and minor (you want to search for)
   bool detectIBeaconUUID(iBeaconData_t *iBeacon, uint16_t maxTimeToSearch = DEFAULT_DETECTION_TIME);  // necessary: uuid (you want to search for)
   /* Example response:
@@ -142,32 +385,223 @@ public:
     00A0500B1710 – [P3] MAC Address
     -078 – [P4] RSSI (dBm)
   */
-  String getMacAddress();
-  void connectToMacAddress(String macAddr, bool master);
-  char readChar();
+  bool startIBeaconScan(uint16_t maxTimeToSearch = DEFAULT_DETECTION_TIME);  // non-blocking, see pollIBeaconScan
+  scanState_t pollIBeaconScan(iBeaconRecord_t *record);                      // call until SCAN_DONE or SCAN_FAILED
+  status_t setDiscoveryDetails(uint8_t show);                              // AT+SHOW (0: mac, 1: +name, ... depends on the firmware)
+  bool startDiscovery(uint16_t maxTimeToSearch = DEFAULT_DETECTION_TIME);  // non-blocking, see pollDiscovery
+  scanState_t pollDiscovery(deviceRecord_t *record);                       // call until SCAN_DONE or SCAN_FAILED
+#endif
+  void stopScan();  // e.g. as soon as the wanted device has been found
+  bool isScanning();
+  status_t getMacAddress(String &macAddress);
+  bool refreshConf();  // bulk read of all shadowed settings
+#if HM11_FEATURE_CONNECTION
+  status_t connectToMacAddress(String macAddr, bool master, uint16_t timeout = DEFAULT_CONNECT_TIME);
+  void setAutoReconnect(bool enable, uint16_t timeout = DEFAULT_RECONNECT_TIME);  // reconnect to the last peer with backoff, see pollConnection
+  void pollConnection();               // call in the main loop while not connected (non-blocking)
+  void disconnect();                   // drops the link, the role stays configured (no reset)
+  linkState_t getLinkState();
+  const linkStats_t *getLinkStats();
+  uint16_t write(const uint8_t *data, uint16_t length);  // non-blocking, returns the number of accepted bytes
+  uint16_t write(const char *str);
+  uint16_t availableForWrite();
+  bool isTxBackpressured();            // back off until it is false again
+  void setTxRate(uint16_t bytesPerSecond);
+  void setTxCoalescing(uint16_t maxDelay);  // in ms, 0 -> off (default)
+  void flushTx();                      // sends held data without waiting for maxDelay
+  const txStats_t *getTxStats();
+  void pollTx();                       // drains the TX queue, call in the main loop
+  void setEventCallback(eventCallback_t callback, void *context = NULL);
+  int16_t readData();                  // application data only, notifications go to the callback (-1 -> none)
+#endif
+  char readChar();                     // raw, tracks the link state (see readData)
+
+  // GPIOs (PIO2..PIOB), remote = the peer which is connected in remote control mode
+  status_t setRemoteControlMode(bool enable);  // module can be controlled remotely
+  status_t setPIO(uint8_t pin, bool level, bool remote = false);
+  status_t setPIOs(uint16_t mask, uint16_t levels, bool remote = false);  // several pins in one exchange
+  int8_t getPIO(uint8_t pin, bool remote = false);  // returns -1 on failure
+  void invalidatePIOShadow();
+#if HM11_FEATURE_HANDSHAKING
   bool handshaking(bool master, char handshakeChar = 'H');
+#endif
+
+  status_t sleepBLE();   // "AT+SLEEP", call wakeUpBLE() before the next command
+  bool wakeUpBLE();
+  moduleState_t getModuleState();
+#if HM11_FEATURE_ENERGY
+  void setCurrentProfile(const currentProfile_t *profile);
+  uint32_t getStateTime(moduleState_t state);  // in ms since the start or resetEnergy()
+  uint32_t getCharge();                        // in uAh, with the current profile
+  void resetEnergy();
+#endif
+
+  recoveryStep_t recover();  // health check, escalates only as far as necessary (see recoveryStep_t)
+  const recoveryStats_t *getRecoveryStats();
 
-  void forceRenew();  // try this if you can not communicate with the BLE-module anymore
+  uint16_t getFirmwareVersion();  // e.g. 540 for "HMSoft V540", 0 -> unknown
+  uint32_t getMillis();        // time base of the backend (BLE_millis), use it instead of millis()
+  uint32_t getCommandCount();  // number of AT commands sent
+  uint32_t getCommandTime();   // total time in ms spent waiting for responses
+  const ramUsage_t *getRAMUsage(api_t api);  // NULL without HM11_RAM_PROFILING
+  void resetRAMUsage();
 
   /* Public class functions (static) */
   static String byteToHexString(uint8_t hex);
   static uint8_t hexStringToByte(String str);
 
+  /* Public constexpr class functions (static) -> used by HM11_IBEACON_PROFILE() */
+  static constexpr bool isHexCharacter(char c)
+  {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F');
+  }
+  static constexpr bool isValidUUID(const char *uuid, uint8_t i = 0)
+  {
+    return (i == 32) ? (uuid[i] == '\0') : (isHexCharacter(uuid[i]) && isValidUUID(uuid, i + 1));
+  }
+  static constexpr bool isValidMacAddress(const char *mac, uint8_t i = 0)
+  {
+    return (i == 12) ? (mac[i] == '\0') : (isHexCharacter(mac[i]) && isValidMacAddress(mac, i + 1));
+  }
+  static constexpr char toHexCharacter(uint16_t value, uint8_t shift)
+  {
+    return (((value >> shift) & 0x0F) > 9) ? char(((value >> shift) & 0x0F) + 'A' - 10) : char(((value >> shift) & 0x0F) + '0');
+  }
+
 private:
+  /* Private member typedefs */
+  typedef enum : uint8_t
+  {
+    DISC_PREFIX = 0,  // "OK+"
+    DISC_TAG    = 1,  // "DISx", "RSSI", "NAME" up to the ':'
+    DISC_MAC    = 2,
+    DISC_RSSI   = 3,
+    DISC_NAME   = 4
+  } discoveryState_t;
+
+  typedef enum : uint8_t  // index of COMMAND_TABLE
+  {
+    CMD_AT    = 0,  // "AT" without verb
+    CMD_ADDR  = 1,
+    CMD_ADTY  = 2,
+    CMD_ADVI  = 3,
+    CMD_BAUD  = 4,
+    CMD_CON   = 5,
+    CMD_DELO  = 6,
+    CMD_DISC  = 7,
+    CMD_DISI  = 8,
+    CMD_IBE   = 9,
+    CMD_IBEA  = 10,
+    CMD_IMME  = 11,
+    CMD_MARJ  = 12,
+    CMD_MINO  = 13,
+    CMD_MODE  = 14,
+    CMD_MPIO  = 15,
+    CMD_NAME  = 16,
+    CMD_PIO   = 17,
+    CMD_POWE  = 18,
+    CMD_PWRM  = 19,
+    CMD_RENEW = 20,
+    CMD_RESET = 21,
+    CMD_ROLE  = 22,
+    CMD_SHOW  = 23,
+    CMD_VERS  = 24,
+    CMD_SLEEP = 25,
+    CMD_COUNT = 26
+  } command_t;
+
+  typedef enum : uint8_t  // index of RESPONSE_TABLE
+  {
+    RSP_OK    = 0,
+    RSP_CONN  = 1,
+    RSP_LOST  = 2,
+    RSP_CONNF = 3,
+    RSP_CONNE = 4,
+    RSP_WAKE  = 5
+  } response_t;
+
   /*  Private constant declerations (static) */
   static const baudrate_t DEFAULT_BAUDRATE           = BAUDRATE0;
   static const uint8_t DEFAULT_RESPONSE_LENGTH       = 8;         // in characters
+  static const uint8_t RESPONSE_GAP_TIME             = 5;         // in ms, silence which ends a response (~5 characters at 9600 Baud)
   static const uint8_t RESET_DELAY                   = 10;        // in ms (discovered empirically -> 5ms was too short)
-  static const uint16_t COMMAND_TIMEOUT_TIME         = 100;       // in ms (discovered empirically)
-  static const uint16_t MAX_DELAY_AFTER_HW_RESET_BLE = 500;       // in ms (discovered empirically)
-  static const uint16_t MAX_DELAY_AFTER_SW_RESET_BLE = 1000;      // in ms (discovered empirically)
+  static const uint16_t COMMAND_TIMEOUT_TIME         = 100;       // in ms (discovered empirically, unknown firmware)
+  static const uint16_t MAX_DELAY_AFTER_HW_RESET_BLE = 500;       // in ms (discovered empirically, unknown firmware)
+  static const uint16_t MAX_DELAY_AFTER_SW_RESET_BLE = 1000;      // in ms (discovered empirically, unknown firmware)
+  static const retryPolicy_t DEFAULT_RETRY_POLICY;
+  static const retryPolicy_t NO_RETRY;
+  static const currentProfile_t DEFAULT_CURRENT_PROFILE;
+  static const uint8_t WAKE_UP_LENGTH                = 100;       // in characters (> 80 wakes the module up)
+
+  // GPIOs
+  static const uint8_t MIN_PIO                     = 2;
+  static const uint8_t MAX_PIO                     = 11;          // PIOB
+  static const uint16_t PIO_MASK                   = 0x0FFC;      // PIO2..PIOB
 
   // I-Beacon detector
   static const uint16_t DEFAULT_DETECTION_TIME     = 5000;        // in ms
-  static const uint16_t MIN_RAM                    = 253;         // in bytes -> keep the RAM > 200 to prevent bugs!
+
+  // connection
+  static const uint16_t DEFAULT_CONNECT_TIME       = 10000;       // in ms
+  static const uint16_t DEFAULT_RECONNECT_TIME     = 3000;        // in ms, per attempt of the auto reconnect
+  static const uint8_t CONN_SETTLE_TIME            = 10;          // in ms -> silence after "OK+CONN"
+  static const uint16_t MIN_RECONNECT_BACKOFF      = 500;         // in ms
+  static const uint16_t MAX_RECONNECT_BACKOFF      = 30000;       // in ms
+  static const uint8_t RX_DATA_SIZE                = 8;           // a notification + 1 (power of two)
+  static const uint8_t TX_PACKET_SIZE              = 20;          // in bytes (payload of one BLE packet)
+  static const uint16_t DEFAULT_TX_RATE            = 2000;        // in bytes/s (discovered empirically)
+  static const uint16_t TX_HIGH_WATERMARK          = HM11_TX_BUFFER_SIZE * 3 / 4;
+  static const uint16_t TX_LOW_WATERMARK           = HM11_TX_BUFFER_SIZE / 4;
+  static const uint8_t TX_PACKET_OVERHEAD_AIR_TIME = 136;         // in us (17 bytes of preamble, header, L2CAP, ATT and CRC at 1Mbit/s)
   //static const uint16_t MAX_NUMBER_IBEACONS        = 6;           // max = 6 (keep the RAM in minde!)
   //static const uint16_t NUMBER_CHARS_PER_DEVICE    = 78;          // including the "OK+DISC:"
 
+  typedef enum : uint8_t
+  {
+    CONF_MAC_ADDRESS  = 0x01,
+    CONF_TX_POWER     = 0x02,
+    CONF_ROLE         = 0x04,  // role and work type (IMME1) are active
+    CONF_MAJOR        = 0x08,
+    CONF_MINOR        = 0x10,
+    CONF_IBEACON      = 0x20   // iBeacon mode is active (setupAsIBeacon)
+  } confFlag_t;
+
+  typedef struct
+  {
+    uint8_t valid;             // confFlag_t bits of the known settings
+    char macAddress[13];
+    txPower_t txPower;
+    bool master;
+    uint16_t major;
+    uint16_t minor;
+  } confShadow_t;
+
+  typedef struct
+  {
+    uint16_t version;          // first firmware version, e.g. 540 for "HMSoft V540"
+    uint32_t unsupported;      // bit (1 << command_t) set -> command is missing
+    uint16_t commandTimeout;   // in ms
+    uint16_t hwResetTime;      // in ms, max. time until ready after the HW reset
+    uint16_t swResetTime;      // in ms, max. time of AT+RESET / AT+RENEW phases
+  } firmware_t;                // entry of FIRMWARE_TABLE
+
+  static const firmware_t FIRMWARE_TABLE[];   // in PROGMEM
+  static const uint32_t IBEACON_COMMANDS;      // bit per command_t of setupAsIBeacon
+
+#ifdef HM11_RAM_PROFILING
+  class RAMProbe  // measures the outermost public API call from construction to destruction
+  {
+  public:
+    RAMProbe(HM11 *ble, api_t api);
+    ~RAMProbe();
+  private:
+    HM11 *ble_;
+    api_t api_;
+    uint8_t *bottom_;   // top of the heap at the beginning
+    uint8_t *top_;      // end of the painted area (below the stack)
+  };
+#endif
+
   /* Private member data */
   volatile uint8_t *rxdPort_;
   uint8_t rxd_;
@@ -179,32 +613,156 @@ private:
   uint8_t rstPin_;
 
   uint32_t baudrate_;
+  retryPolicy_t retryPolicy_ = DEFAULT_RETRY_POLICY;
+
+  // non-blocking scan
+  scanState_t scanState_  = SCAN_IDLE;
+#if HM11_FEATURE_DETECTOR
+  uint8_t scanPos_        = 0;    // position within the current "OK+DISC:" line
+  uint16_t scanTimeout_   = 0;
+  uint32_t scanStartMillis_ = 0;
+  iBeaconRecord_t scanRecord_;    // record being parsed
+  bool scanDevices_       = false;  // generic discovery instead of iBeacons
+  uint8_t discState_      = 0;      // discoveryState_t
+  uint8_t discPos_        = 0;
+  char discTag_[5];                 // e.g. "DIS0", "RSSI", "NAME", "DISCE"
+  bool discPending_       = false;  // discRecord_ has not been handed out yet
+  deviceRecord_t discRecord_;       // record being parsed
+#endif
+
+  // configuration shadow (getters answer from it, setters write through)
+  confShadow_t conf_ = {0, "", POWER_0DBM, false, 0, 0};
+
+  // GPIO shadow ([0] = local, [1] = remote)
+  uint16_t pioKnown_[2]   = {0, 0};   // bit set -> level of the pin is known
+  uint16_t pioLevels_[2]  = {0, 0};
+
+#if HM11_FEATURE_CONNECTION
+  // connection
+  linkState_t linkState_  = LINK_DISCONNECTED;
+  uint8_t rxMatchPos_     = 0;    // position within the notification (7: "OK+CONN" undecided)
+  response_t rxMatch_     = RSP_CONN;
+  bool rxCollect_         = false;  // readData() is demultiplexing
+  uint8_t rxData_[RX_DATA_SIZE];    // application data released by the demultiplexer
+  uint8_t rxDataHead_     = 0;
+  uint8_t rxDataCount_    = 0;
+  uint32_t rxLastMillis_  = 0;    // last character seen by the demultiplexer
+  eventCallback_t eventCallback_ = NULL;
+  void *eventContext_     = NULL;
+  bool autoReconnect_     = false;
+  bool reconnecting_      = false;  // "AT+CON" sent by pollConnection
+  uint16_t reconnectTimeout_ = DEFAULT_RECONNECT_TIME;
+  char lastPeer_[13]      = "";
+  bool lastPeerMaster_    = true;
+  uint32_t connectStartMillis_ = 0;
+  uint32_t lastDropMillis_ = 0;
+  uint16_t reconnectBackoff_ = MIN_RECONNECT_BACKOFF;
+  linkStats_t linkStats_  = {0, 0, 0, 0, 0, 0};
+
+  // TX queue
+  uint8_t txBuffer_[HM11_TX_BUFFER_SIZE];
+  uint16_t txHead_        = 0;    // free running, masked on access
+  uint16_t txTail_        = 0;
+  uint16_t txRate_        = DEFAULT_TX_RATE;
+  uint32_t txCredit_      = 0;    // in bytes * 1000
+  uint32_t txLastMillis_  = 0;
+  bool txBackpressure_    = false;
+  uint16_t txCoalesceDelay_ = 0;  // in ms, 0 -> no coalescing
+  uint32_t txOldestMillis_ = 0;   // oldest byte in the queue
+  bool txFlush_           = false;
+  txStats_t txStats_      = {0, 0, 0, 0};
+#endif
+
+  // firmware (see FIRMWARE_TABLE)
+  uint16_t firmwareVersion_ = 0;
+  uint32_t unsupported_   = 0;    // bit (1 << command_t)
+  uint16_t commandTimeout_ = COMMAND_TIMEOUT_TIME;
+  uint16_t hwResetTime_   = MAX_DELAY_AFTER_HW_RESET_BLE;
+  uint16_t swResetTime_   = MAX_DELAY_AFTER_SW_RESET_BLE;
+
+  // module state (see getModuleState)
+  moduleState_t moduleState_ = STATE_DISABLED;
+  moduleState_t baseState_ = STATE_ADVERTISING;   // when not scanning, connected, ... (factory default: peripheral)
+#if HM11_FEATURE_ENERGY
+  uint32_t stateSince_    = 0;
+  uint32_t stateTime_[STATE_COUNT] = {};  // in ms
+  currentProfile_t currentProfile_ = DEFAULT_CURRENT_PROFILE;
+#endif
+
+  // statistics
+  telemetryStats_t telemetryStats_ = {0, 0, 0, 0, 0};
+  recoveryStats_t recoveryStats_ = {RECOVERY_PING, 0, 0, {0, 0, 0, 0, 0, 0}};
+  uint32_t commandCount_  = 0;
+  uint32_t commandTime_   = 0;
   //iBeaconData_t iBeaconData_[MAX_NUMBER_IBEACONS];
+#ifdef HM11_RAM_PROFILING
+  uint8_t probeDepth_     = 0;    // nested public API calls
+  ramUsage_t ramUsage_[API_COUNT] = {};
+#endif
 
   /* Private member functions */
   void hwResetBLE();
+  void invalidateShadow();
+  status_t checkPIOLink(bool remote);
   void swResetBLE();
+#if HM11_FEATURE_RENEW
   bool renewBLE();
-  bool setConf(String cmd);
+#endif
+  bool isAlive();
+  void detectFirmware();
+  void setModuleState(moduleState_t state);
+  bool recoverStep(recoveryStep_t step);
+  status_t setConf(command_t cmd, const char *arg = "", const retryPolicy_t *policy = NULL);  // NULL -> retryPolicy_
+  status_t setConf(command_t cmd, char arg, const retryPolicy_t *policy = NULL);
+  status_t setIBeaconMode();
+  status_t setIBeaconId(command_t cmd, uint16_t value);
+  status_t setConf_P(PGM_P cmd, const retryPolicy_t *policy = NULL);  // cmd including the "AT+"
   bool setBaudrate(baudrate_t baudrate);
   bool setBaudrate();
-  String getConf(String cmd);
+  status_t getConf(command_t cmd, String &response, const char *arg = "", const retryPolicy_t *policy = NULL);
+  bool retryBackoff(status_t status, uint8_t attempt, const retryPolicy_t *policy);
   uint32_t getBaudrate();
-  String sendDirectBLECommand(String cmd, uint16_t timeout = COMMAND_TIMEOUT_TIME);
+  status_t sendCommand(command_t cmd, const char *arg, bool query, String &response, uint16_t timeout = 0);  // 0 -> timeout of the firmware
+  void writeCommand(command_t cmd, const char *arg, bool query);
+  status_t sendDirectBLECommand_P(PGM_P cmd, String &response, uint16_t timeout = 0);
+  status_t readBLEResponse(String &response, bool waitForMore, uint16_t timeout, bool anyResponse = false);
+  void writeBLECommand_P(PGM_P cmd);
+#if HM11_FEATURE_DETECTOR
+  scanState_t parseScanCharacter(char c);
+  scanState_t parseDiscoveryCharacter(char c, deviceRecord_t *record);
+  bool startScan(command_t cmd, uint16_t maxTimeToSearch);
+  bool findIBeacon(iBeaconData_t *iBeacon, uint16_t maxTimeToSearch, bool matchVersion);
+#endif
+#if HM11_FEATURE_CONNECTION
+  status_t startConnect();
+  void cancelConnect();
+  void demuxCharacter(char c);
+  void settleNotification();
+  void pushData(char c);
+  void notify(event_t event);
+  void linkConnected();
+  uint16_t txQueued();
+#endif
+  status_t setRole(bool master);
 
   /* Private class functions (static) */
+  static bool hasResponse(const String &response, response_t rsp);
   static int16_t getFreeRAM();
   static char nibbleToHexCharacter(uint8_t nibble);
   static uint8_t hexCharacterToNibble(char hex);
 
-  /* Private virtual functions */
-  virtual void BLESerial_begin(int32_t baudrate);
-  virtual void BLESerial_end();
-  virtual bool BLESerial_ready();  // while(!BLESerial_ready());
-  virtual uint16_t BLESerial_available();
-  virtual void BLESerial_print(String str);
-  virtual int16_t BLESerial_read();
-  virtual void BLESerial_flush();
+  /* Private virtual functions (pure -> implemented by the backends) */
+  virtual void BLESerial_begin(int32_t baudrate) = 0;
+  virtual void BLESerial_end() = 0;
+  virtual bool BLESerial_ready() = 0;  // while(!BLESerial_ready());
+  virtual uint16_t BLESerial_available() = 0;
+  virtual void BLESerial_print(String str) = 0;
+  virtual void BLESerial_write(uint8_t b) = 0;
+  virtual int16_t BLESerial_read() = 0;
+  virtual void BLESerial_flush() = 0;
+  virtual bool BLESerial_wait(uint16_t timeout);  // wait until data is available or timeout
+  virtual uint32_t BLE_millis();
+  virtual void BLE_delay(uint32_t ms);
 };
 
 #endif
@@ -0,0 +1,228 @@
+#ifndef _LIB_HM11_AdvertModel_H_
+#define _LIB_HM11_AdvertModel_H_
+/*******************************************************************************
+* \file    HM11_AdvertModel.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Advertising interval / TX power trade-off model (host only)
+*
+* \section DESCRIPTION
+* Monte Carlo model of an iBeacon (setupAsIBeacon) and a detector
+* (detectIBeacon) to choose the advertising interval, the TX power and the
+* scan time by numbers instead of by feel:
+* - the beacon sends an advertising event every interval + 0..10ms random
+*   delay (BLE spec), one PDU on each of the channels 37, 38 and 39
+* - the detector listens on one channel per scan window and rotates them
+* - a PDU is received if the detector listens on its channel and the RSSI
+*   (log-distance path loss, shadowing per trial, fast fading per PDU) is
+*   above the sensitivity
+* - the beacon current is the sleep current plus the charge of an event per
+*   interval. setIBeaconMode() configures PWRM1 (no auto sleep), so the
+*   default environment keeps the beacon awake and the interval hardly
+*   changes its current; set autoSleep to model a PWRM0 beacon
+* sweep() evaluates every (interval, power, scan time) combination and
+* marks the Pareto-optimal ones (detection probability, time to the first
+* detection, beacon current, charge per scan), printParetoTable() prints
+* them.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_AdvertModel
+{
+public:
+  /* Public member typedefs */
+  typedef struct
+  {
+    double distance;           // in m between the beacon and the detector
+    double pathLoss;           // exponent (2 free space, 2.5..3.5 indoor)
+    double shadowing;          // in dB, sigma of the slow fading (per trial)
+    double fading;             // in dB, sigma of the fast fading (per PDU)
+    double sensitivity;        // in dBm of the detector
+    double scanWindow;         // in ms per channel of the detector
+    bool autoSleep;            // PWRM0 -> the beacon sleeps between the events
+    double activeCurrent;      // in uA, awake (see HM11::currentProfile_t)
+    double sleepCurrent;       // in uA
+    double scanCurrent;        // in uA, detector while scanning
+    double txCurrent[4];       // in uA while sending a PDU, per txPower_t
+    double eventOverhead;      // in ms awake per advertising event (wake up, radio setup)
+    uint16_t trials;           // Monte Carlo runs per combination
+  } environment_t;
+
+  typedef struct
+  {
+    HM11::advertInterval_t interval;
+    HM11::txPower_t power;
+    uint16_t scanTime;         // in ms (maxTimeToSearch)
+    double probability;        // detected within the scan time
+    double firstDetection;     // in ms, mean of the detected trials
+    double beaconCurrent;      // in uA, average
+    double scanCharge;         // in uAh per scan
+    bool pareto;               // not dominated by another combination
+  } result_t;
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_AdvertModel(const environment_t *environment = NULL, uint32_t seed = 1) :
+    env_(environment ? *environment : defaultEnvironment()), seed_(seed) {};
+  ~HM11_AdvertModel() {};
+  // Example instantation:
+  // HM11_AdvertModel model;
+  // const uint16_t scanTimes[] = {500, 1000, 2000, 3000, 5000};
+  // model.sweep(scanTimes, 5);
+  // model.printParetoTable();   // see extras/bench/bench_advert_sweep.cpp
+
+  /* Public member functions */
+  result_t evaluate(HM11::advertInterval_t interval, HM11::txPower_t power, uint16_t scanTime)
+  {
+    result_t result = {interval, power, scanTime, 0, 0, 0, 0, false};
+    rng_.seed(seed_);   // same random numbers for every combination -> differences are not noise
+    uint16_t detected = 0;
+    double firstSum = 0;
+    for (uint16_t i = 0; i < env_.trials; i++)
+    {
+      double first = detect(intervalMs(interval), powerDbm(power), scanTime);
+      if (first >= 0) {detected++; firstSum += first;}
+    }
+    result.probability = double(detected) / env_.trials;
+    result.firstDetection = detected ? firstSum / detected : scanTime;
+
+    /* beacon: sleeping (or awake) plus the charge of one event per interval */
+    double period = intervalMs(interval) + MAX_ADV_DELAY / 2;
+    double txCharge = CHANNELS * PDU_TIME * env_.txCurrent[power];   // in uA * ms
+    if (env_.autoSleep) result.beaconCurrent = env_.sleepCurrent + (txCharge + env_.eventOverhead * env_.activeCurrent) / period;
+    else result.beaconCurrent = env_.activeCurrent + (txCharge - CHANNELS * PDU_TIME * env_.activeCurrent) / period;
+    result.scanCharge = env_.scanCurrent * scanTime / 3600000.0;
+    return result;
+  }
+
+  const std::vector<result_t> &sweep(const uint16_t *scanTimes, uint8_t count)
+  {
+    results_.clear();
+    for (uint8_t s = 0; s < count; s++)
+      for (uint8_t p = HM11::POWER_N23DBM; p <= HM11::POWER_6DBM; p++)
+        for (uint8_t i = HM11::INTERV_100MS; i <= HM11::INTERV_1285MS; i++)
+          results_.push_back(evaluate(HM11::advertInterval_t(i), HM11::txPower_t(p), scanTimes[s]));
+
+    for (size_t i = 0; i < results_.size(); i++)
+    {
+      results_[i].pareto = true;
+      for (size_t j = 0; j < results_.size() && results_[i].pareto; j++)
+      {
+        if (j != i && dominates(results_[j], results_[i])) results_[i].pareto = false;
+      }
+    }
+    return results_;
+  }
+
+  void printParetoTable(FILE *out = stdout, double minProbability = 0.0)
+  {
+    fprintf(out, "interval  power   scan  P(det)  t_first  I_beacon  Q_scan\n");
+    fprintf(out, "    [ms]  [dBm]   [ms]     [%%]     [ms]      [uA]   [uAh]\n");
+    for (size_t i = 0; i < results_.size(); i++)
+    {
+      const result_t &r = results_[i];
+      if (!r.pareto || r.probability < minProbability) continue;
+      fprintf(out, "%8u  %5d  %5u  %6.1f  %7.0f  %8.0f  %6.2f\n", intervalMs(r.interval), powerDbm(r.power),
+        r.scanTime, 100.0 * r.probability, r.firstDetection, r.beaconCurrent, r.scanCharge);
+    }
+  }
+
+  static const environment_t &defaultEnvironment()
+  {
+    /* CC2541 (HM11): -94dBm sensitivity, TX 15..22mA from -23 to +6dBm, datasheet sleep and active currents */
+    static const environment_t ENVIRONMENT = {5.0, 2.5, 4.0, 3.0, -94.0, 10.0, false,   // PWRM1 like setIBeaconMode()
+      8500.0, 600.0, 15000.0, {15000.0, 16500.0, 18200.0, 22000.0}, 2.0, 500};
+    return ENVIRONMENT;
+  }
+
+  /* Public class functions (static) */
+  static uint16_t intervalMs(HM11::advertInterval_t interval)
+  {
+    static const uint16_t INTERVALS[] = {100, 150, 210, 320, 420, 550, 760, 850, 1020, 1285};
+    return INTERVALS[interval];
+  }
+
+  static int8_t powerDbm(HM11::txPower_t power)
+  {
+    static const int8_t POWERS[] = {-23, -6, 0, 6};
+    return POWERS[power];
+  }
+
+private:
+  /* Private constant declerations (static) */
+  static constexpr double MAX_ADV_DELAY  = 10.0;    // in ms, random delay per event (BLE spec)
+  static constexpr double PDU_SPACING    = 0.5;     // in ms between the channels of an event
+  static constexpr double PDU_TIME       = 0.376;   // in ms, 47 bytes at 1Mbit/s
+  static constexpr double LOSS_AT_1M     = 41.0;    // in dB (0dBm -> -41dBm at 1m)
+  static const uint8_t CHANNELS          = 3;
+
+  /* Private member data */
+  environment_t env_;
+  uint32_t seed_;
+  std::mt19937 rng_;
+  std::vector<result_t> results_;
+
+  /* Private member functions */
+  double detect(uint16_t interval, int8_t power, uint16_t scanTime)  // one trial, returns the first detection in ms (-1 -> none)
+  {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> fading(0.0, env_.fading);
+    std::normal_distribution<double> shadowing(0.0, env_.shadowing);
+
+    double rssi = power - LOSS_AT_1M - 10.0 * env_.pathLoss * log10(env_.distance) + shadowing(rng_);
+    double scanPhase = uniform(rng_) * CHANNELS * env_.scanWindow;   // detector channel rotation
+    for (double t = uniform(rng_) * interval; t < scanTime; t += interval + uniform(rng_) * MAX_ADV_DELAY)
+    {
+      for (uint8_t ch = 0; ch < CHANNELS; ch++)
+      {
+        double pdu = t + ch * PDU_SPACING;
+        if (pdu + PDU_TIME > scanTime) return -1;
+        uint8_t listening = uint8_t(fmod(pdu + scanPhase, CHANNELS * env_.scanWindow) / env_.scanWindow);
+        if (listening == ch && rssi + fading(rng_) >= env_.sensitivity) return pdu + PDU_TIME;
+      }
+    }
+    return -1;
+  }
+
+  static bool dominates(const result_t &a, const result_t &b)  // a is at least as good in every objective and better in one
+  {
+    bool noWorse = a.probability >= b.probability && a.firstDetection <= b.firstDetection &&
+      a.beaconCurrent <= b.beaconCurrent && a.scanCharge <= b.scanCharge;
+    bool better = a.probability > b.probability || a.firstDetection < b.firstDetection ||
+      a.beaconCurrent < b.beaconCurrent || a.scanCharge < b.scanCharge;
+    return noWorse && better;
+  }
+};
+
+#endif
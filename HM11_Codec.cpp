@@ -0,0 +1,322 @@
+/*******************************************************************************
+* \file    HM11_Codec.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Codec.h"
+
+/* ======================= Module constant declaration ====================== */
+
+/* ======================== Module macro declaration ======================== */
+
+/* ====================== Module class instantiations ======================= */
+
+/* ======================== Public member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     encode
+  * \brief  encodes the changed channels as zigzag deltas (varint) or, when
+  *         due, all channels as a keyframe
+  *
+  * \param  values  one value per channel
+  * \param  frame   output buffer of at least MAX_FRAME_SIZE bytes
+  * \return frame length in bytes
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Codec::encode(const int16_t *values, uint8_t *frame)
+  {
+    uint8_t length;
+    if (keyframeCountdown_ == 0)
+    {
+      length = encodeKeyframe(values, frame);
+      keyframeCountdown_ = (keyframeInterval_ > 0) ? keyframeInterval_ : UINT8_MAX;
+      encoderStats_.frames++;
+      encoderStats_.rawBytes += 2 * channels_;
+      encoderStats_.codedBytes += length;
+      return length;
+    }
+    if (keyframeInterval_ > 0) keyframeCountdown_--;
+
+    uint8_t mask = 0;
+    length = 1;
+    for (uint8_t i = 0; i < channels_; i++)
+    {
+      /* the delta wraps around like the values -> exact for any jump */
+      int16_t delta = int16_t(uint16_t(values[i]) - uint16_t(encoded_[i]));
+      if (delta == 0) continue;
+      mask |= 1 << i;
+      encoded_[i] = values[i];
+
+      uint16_t zigzag = (uint16_t(delta) << 1) ^ uint16_t(delta >> 15);
+      while (zigzag >= 0x80)
+      {
+        frame[length++] = uint8_t(zigzag) | 0x80;
+        zigzag >>= 7;
+      }
+      frame[length++] = uint8_t(zigzag);
+    }
+    frame[0] = mask;
+
+    encoderStats_.frames++;
+    encoderStats_.rawBytes += 2 * channels_;
+    encoderStats_.codedBytes += length;
+    return length;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     decode
+  * \brief  feeds one received byte into the decoder
+  *
+  * \param  b   received byte
+  * \return true if a frame is complete (see getValues)
+  --------------------------------------------------------------------------- */
+  bool HM11_Codec::decode(uint8_t b)
+  {
+    decoderStats_.codedBytes++;
+    if (decodeChannel_ == DECODE_KEYFRAME) return decodeKeyframe(b);
+    if (decodeChannel_ == DECODE_MASK)
+    {
+      if (b == (KEYFRAME | channels_))
+      {
+        decodeChannel_ = DECODE_KEYFRAME;
+        decodeShift_ = 0;
+        decodeCrc_ = crc8(0, b);
+        return false;
+      }
+      if (!decodeSynced_)
+      {
+        decoderStats_.skippedBytes++;
+        return false;
+      }
+      if ((b >> channels_) || decodeCountdown_ == 0)   // bits of channels which do not exist or keyframe missing
+      {
+        decodeError();
+        return false;
+      }
+      decodeMask_ = b;
+      decodeChannel_ = 0;
+      return nextChannel();
+    }
+
+    decodeValue_ |= uint16_t(b & 0x7F) << decodeShift_;
+    decodeShift_ += 7;
+    if (b & 0x80)
+    {
+      if (decodeShift_ > 14) decodeError();   // a 16 bit zigzag value has max. 3 bytes
+      return false;
+    }
+
+    int16_t delta = int16_t((decodeValue_ >> 1) ^ -(decodeValue_ & 1));
+    decoded_[decodeChannel_] = int16_t(uint16_t(decoded_[decodeChannel_]) + uint16_t(delta));
+    decodeMask_ &= ~(1 << decodeChannel_);
+    return nextChannel();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getValues
+  * \brief  returns the values of the last decoded frame
+  *
+  * \return one value per channel
+  --------------------------------------------------------------------------- */
+  const int16_t *HM11_Codec::getValues()
+  {
+    return decoded_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getChannels
+  * \brief  returns the number of channels per frame
+  *
+  * \return number of channels
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Codec::getChannels()
+  {
+    return channels_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setKeyframeInterval
+  * \brief  sets the number of delta frames between two keyframes, takes
+  *         effect after the next keyframe
+  *
+  * \param  frames  delta frames per keyframe (0: only after reset())
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11_Codec::setKeyframeInterval(uint8_t frames)
+  {
+    keyframeInterval_ = frames;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     reset
+  * \brief  restarts both directions from zero (e.g. after a reconnect), the
+  *         next encoded frame is a keyframe
+  --------------------------------------------------------------------------- */
+  void HM11_Codec::reset()
+  {
+    memset(encoded_, 0, sizeof(encoded_));
+    memset(decoded_, 0, sizeof(decoded_));
+    memset(&encoderStats_, 0, sizeof(encoderStats_));
+    memset(&decoderStats_, 0, sizeof(decoderStats_));
+    keyframeCountdown_ = 0;
+    decodeCountdown_ = 0;
+    decodeSynced_ = false;
+    decodeChannel_ = DECODE_MASK;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getEncoderStats
+  * \brief  returns the statistics of the encoder
+  *
+  * \return statistics (see struct in the header file)
+  --------------------------------------------------------------------------- */
+  const HM11_Codec::codecStats_t *HM11_Codec::getEncoderStats()
+  {
+    return &encoderStats_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getDecoderStats
+  * \brief  returns the statistics of the decoder
+  *
+  * \return statistics (see struct in the header file)
+  --------------------------------------------------------------------------- */
+  const HM11_Codec::codecStats_t *HM11_Codec::getDecoderStats()
+  {
+    return &decoderStats_;
+  }
+
+/* ======================== Public class Functions ========================== */
+/** -------------------------------------------------------------------------
+  * \fn     getRatio
+  * \brief  returns the compression ratio of one direction
+  *
+  * \param  stats  getEncoderStats() or getDecoderStats()
+  * \return raw bytes / coded bytes in 1/100 (e.g. 400 -> 4:1)
+  --------------------------------------------------------------------------- */
+  uint16_t HM11_Codec::getRatio(const codecStats_t *stats)
+  {
+    return (stats->codedBytes > 0) ? (stats->rawBytes * 100) / stats->codedBytes : 0;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     crc8
+  * \brief  CRC-8 (polynomial 0x07) over one more byte
+  *
+  * \param  crc  CRC of the previous bytes (0 for the first byte)
+  * \param  b    next byte
+  * \return CRC including b
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Codec::crc8(uint8_t crc, uint8_t b)
+  {
+    crc ^= b;
+    for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? uint8_t((crc << 1) ^ 0x07) : uint8_t(crc << 1);
+    return crc;
+  }
+
+/* ======================= Private member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     encodeKeyframe
+  * \brief  encodes all channels absolute: marker, values, CRC-8
+  *
+  * \param  values  one value per channel
+  * \param  frame   output buffer
+  * \return frame length in bytes
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Codec::encodeKeyframe(const int16_t *values, uint8_t *frame)
+  {
+    uint8_t length = 0;
+    frame[length++] = KEYFRAME | channels_;
+    for (uint8_t i = 0; i < channels_; i++)
+    {
+      encoded_[i] = values[i];
+      frame[length++] = uint8_t(values[i]);
+      frame[length++] = uint8_t(uint16_t(values[i]) >> 8);
+    }
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < length; i++) crc = crc8(crc, frame[i]);
+    frame[length++] = crc;
+    encoderStats_.keyframes++;
+    return length;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     decodeKeyframe
+  * \brief  feeds one byte of a keyframe (after the marker) into the decoder
+  *
+  * \param  b   received byte
+  * \return true if the keyframe is complete and its CRC matched
+  --------------------------------------------------------------------------- */
+  bool HM11_Codec::decodeKeyframe(uint8_t b)
+  {
+    if (decodeShift_ < 2 * channels_)
+    {
+      uint8_t channel = decodeShift_ >> 1;
+      if (decodeShift_ & 1) keyframe_[channel] = int16_t(uint16_t(keyframe_[channel]) | (uint16_t(b) << 8));
+      else keyframe_[channel] = b;
+      decodeShift_++;
+      decodeCrc_ = crc8(decodeCrc_, b);
+      return false;
+    }
+
+    decodeChannel_ = DECODE_MASK;
+    if (b != decodeCrc_)   // e.g. a delta byte which looked like the marker
+    {
+      decodeError();
+      return false;
+    }
+    memcpy(decoded_, keyframe_, sizeof(decoded_));
+    decodeCountdown_ = (keyframeInterval_ > 0) ? keyframeInterval_ : UINT8_MAX;
+    decodeSynced_ = true;
+    decoderStats_.frames++;
+    decoderStats_.keyframes++;
+    decoderStats_.rawBytes += 2 * channels_;
+    return true;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     nextChannel
+  * \brief  selects the next changed channel of the frame being decoded
+  *
+  * \return true if no channel is left -> the frame is complete
+  --------------------------------------------------------------------------- */
+  bool HM11_Codec::nextChannel()
+  {
+    decodeValue_ = 0;
+    decodeShift_ = 0;
+    while (decodeChannel_ < channels_ && !(decodeMask_ & (1 << decodeChannel_))) decodeChannel_++;
+    if (decodeChannel_ < channels_) return false;
+
+    decodeChannel_ = DECODE_MASK;
+    if (keyframeInterval_ > 0) decodeCountdown_--;
+    decoderStats_.frames++;
+    decoderStats_.rawBytes += 2 * channels_;
+    return true;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     decodeError
+  * \brief  drops the frame being decoded, the following bytes are skipped
+  *         until the next valid keyframe
+  --------------------------------------------------------------------------- */
+  void HM11_Codec::decodeError()
+  {
+    if (decodeSynced_) decoderStats_.errors++;   // counted once per lost sync
+    decodeSynced_ = false;
+    decodeChannel_ = DECODE_MASK;
+  }
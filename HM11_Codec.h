@@ -0,0 +1,130 @@
+#ifndef _LIB_HM11_Codec_H_
+#define _LIB_HM11_Codec_H_
+/*******************************************************************************
+* \file    HM11_Codec.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Delta + varint compression of telemetry frames for the data link
+*
+* \section DESCRIPTION
+* A frame consists of up to 7 int16 channels (e.g. the readings of the
+* sensors). encode() sends only the channels which changed since the
+* previous frame: one byte with a bit per changed channel followed by the
+* zigzag encoded deltas as variable-length integers (7 bits per byte, MSB =
+* more bytes follow). A slowly changing channel costs one byte, an unchanged
+* one nothing, so a frame shrinks from 2 bytes per channel to typically 1..5
+* bytes. The peer feeds the received bytes into decode() which rebuilds the
+* frames byte by byte (e.g. with readData(), or the raw bytes of the UART if
+* the link is managed elsewhere).
+* Every keyframe interval (and as the first frame after reset()) encode()
+* sends a keyframe instead: the marker KEYFRAME | channels, the absolute
+* values (little endian) and a CRC-8 over all of it. The decoder expects the
+* keyframes with the same interval (set it on both sides): if a byte got
+* lost, the keyframe is missing at its place (or its CRC does not match) and
+* the decoder drops everything up to the next valid keyframe instead of
+* accumulating wrong deltas. A decoder which joins late waits for the next
+* keyframe too. The deltas themselves are not protected, so the frames
+* between the loss and its detection are wrong; call reset() on both sides
+* after (re)connecting.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <Arduino.h>
+
+/* ==================== Global module constant declaration ================== */
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Codec
+{
+public:
+  /* Public member typedefs */
+  typedef struct
+  {
+    uint32_t frames;           // encoded or decoded frames (keyframes included)
+    uint32_t keyframes;
+    uint32_t rawBytes;         // 2 bytes per channel and frame
+    uint32_t codedBytes;       // bytes on the link
+    uint16_t errors;           // invalid frames or missing keyframes (decoder only)
+    uint32_t skippedBytes;     // dropped while waiting for a keyframe (decoder only)
+  } codecStats_t;            // one per direction, see getEncoderStats() / getDecoderStats()
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Codec(uint8_t channels) : channels_((channels > MAX_CHANNELS) ? MAX_CHANNELS : channels) {reset();};
+  ~HM11_Codec() {};
+  // Example instantation:
+  // HM11_Codec codec(4);
+  // BLE.write(frame, codec.encode(readings, frame));   // sender
+  // int16_t b = BLE.readData();
+  // if (b >= 0 && codec.decode(b)) use(codec.getValues());   // peer
+
+  /* Public constants */
+  static const uint8_t MAX_CHANNELS   = 7;                     // the MSB of the mask marks a keyframe
+  static const uint8_t MAX_FRAME_SIZE = 1 + 3 * MAX_CHANNELS;  // mask + 3 bytes per delta (> keyframe)
+  static const uint8_t KEYFRAME       = 0x80;                  // | channels
+  static const uint8_t DEFAULT_KEYFRAME_INTERVAL = 32;         // in frames
+
+  /* Public member functions */
+  uint8_t encode(const int16_t *values, uint8_t *frame);  // returns the frame length
+  bool decode(uint8_t b);                                 // true as soon as a frame is complete
+  const int16_t *getValues();                             // last decoded frame
+  uint8_t getChannels();
+  void setKeyframeInterval(uint8_t frames);               // 0: only after reset(), same on both sides
+  void reset();
+  const codecStats_t *getEncoderStats();
+  const codecStats_t *getDecoderStats();
+  static uint16_t getRatio(const codecStats_t *stats);    // raw / coded in 1/100
+  static uint8_t crc8(uint8_t crc, uint8_t b);            // polynomial 0x07, start with 0
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t DECODE_MASK     = 0xFF;  // decodeChannel_ while waiting for the mask
+  static const uint8_t DECODE_KEYFRAME = 0xFE;  // decodeChannel_ while receiving a keyframe
+
+  /* Private member data */
+  uint8_t channels_;
+  int16_t encoded_[MAX_CHANNELS];   // previous frame of the encoder
+  int16_t decoded_[MAX_CHANNELS];   // previous frame of the decoder
+  int16_t keyframe_[MAX_CHANNELS];  // keyframe being received (until the CRC matched)
+  uint8_t keyframeInterval_ = DEFAULT_KEYFRAME_INTERVAL;
+  uint8_t keyframeCountdown_;       // delta frames until the next keyframe (encoder)
+  uint8_t decodeCountdown_;         // delta frames until the next keyframe (decoder)
+  bool decodeSynced_;               // false after reset() or an error -> waits for a keyframe
+  uint8_t decodeMask_;              // channels which are still expected
+  uint8_t decodeChannel_;
+  uint16_t decodeValue_;            // zigzag value being received
+  uint8_t decodeShift_;             // bit position (deltas) or byte index (keyframe)
+  uint8_t decodeCrc_;
+  codecStats_t encoderStats_;
+  codecStats_t decoderStats_;
+
+  /* Private member functions */
+  uint8_t encodeKeyframe(const int16_t *values, uint8_t *frame);
+  bool decodeKeyframe(uint8_t b);
+  bool nextChannel();
+  void decodeError();
+};
+
+#endif
@@ -0,0 +1,355 @@
+#ifndef _LIB_HM11_Gateway_H_
+#define _LIB_HM11_Gateway_H_
+/*******************************************************************************
+* \file    HM11_Gateway.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Multi-threaded iBeacon scan service for Linux gateways
+*
+* \section DESCRIPTION
+* The gateway fronts many serial attached HM11 modules (HM11_PosixSerial).
+* Every module gets its own I/O thread which blocks in poll() on the tty and
+* parses the scan records. The records are pushed into a bounded lock-free
+* multi-producer queue which is consumed by one aggregation thread. The
+* aggregation thread deduplicates records of the same iBeacon seen by
+* several modules within a time window and hands the rest to the callback.
+* A module which does not answer (or gets unplugged) is set up again every
+* SETUP_RETRY_TIME until it does.
+* The stats report the throughput in records/s and the end-to-end latency
+* (record parsed -> record aggregated).
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "HM11_PosixSerial.h"
+
+/* ==================== Global module constant declaration ================== */
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Gateway
+{
+public:
+  /* Public member typedefs */
+  typedef struct
+  {
+    HM11::iBeaconRecord_t record;
+    uint8_t module;             // index of the receiving module
+    uint64_t timestamp;         // parse time in ns (steady clock)
+  } gatewayRecord_t;
+
+  typedef struct
+  {
+    uint64_t received;          // records parsed by all modules
+    uint64_t forwarded;         // records handed to the callback
+    uint64_t duplicates;        // records dropped by the deduplication
+    uint64_t dropped;           // records dropped because the queue was full
+    uint64_t setupFailures;     // begin() or the detector setup failed (retried)
+    uint64_t latencySum;        // in ns
+    uint64_t latencyMax;        // in ns
+  } gatewayStats_t;
+
+  typedef void (*recordCallback_t)(const gatewayRecord_t *record, void *context);
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Gateway(recordCallback_t callback, void *context = NULL,
+    uint16_t dedupWindow = DEFAULT_DEDUP_WINDOW, uint16_t scanTime = DEFAULT_SCAN_TIME) :
+    callback_(callback), context_(context),
+    dedupWindow_(dedupWindow), scanTime_(scanTime),
+    queue_(QUEUE_SIZE) {};
+  ~HM11_Gateway()
+  {
+    stop();
+    for (size_t i = 0; i < modules_.size(); i++) delete modules_[i];
+  };
+  // Example instantation:
+  // HM11_Gateway gateway(onRecord);
+  // gateway.addPort("/dev/ttyUSB0");
+  // gateway.addPort("/dev/ttyUSB1");
+  // gateway.start();
+
+  /* Public member functions */
+  int16_t addPort(const char *device)  // returns the module index (before start() only)
+  {
+    if (running_) return -1;
+    modules_.push_back(new HM11_PosixSerial(device));
+    return int16_t(modules_.size() - 1);
+  }
+
+  void start()
+  {
+    if (running_) return;
+    running_ = true;
+    aggregating_ = true;
+    startTime_ = now();
+    setUp_ = 0;
+    readyTime_ = 0;
+    aggregator_ = std::thread(&HM11_Gateway::aggregate, this);
+    for (size_t i = 0; i < modules_.size(); i++)
+    {
+      workers_.push_back(std::thread(&HM11_Gateway::scan, this, uint8_t(i)));
+    }
+  }
+
+  void stop()
+  {
+    if (!running_) return;
+    running_ = false;
+    for (size_t i = 0; i < workers_.size(); i++) workers_[i].join();
+    workers_.clear();
+    aggregating_ = false;   // drain the queue, then stop
+    aggregator_.join();
+  }
+
+  gatewayStats_t getStats()
+  {
+    gatewayStats_t stats;
+    stats.received      = received_;
+    stats.forwarded     = forwarded_;
+    stats.duplicates    = duplicates_;
+    stats.dropped       = dropped_;
+    stats.setupFailures = setupFailures_;
+    stats.latencySum    = latencySum_;
+    stats.latencyMax    = latencyMax_;
+    return stats;
+  }
+
+  uint32_t getSetupTime()  // in ms from start() until all modules were set up, 0 -> not yet
+  {
+    uint64_t ready = readyTime_;
+    return ready ? uint32_t((ready - startTime_) / 1000000ULL) : 0;
+  }
+
+  uint32_t getRecordsPerSecond()  // aggregated records since all modules were set up (since start() until then)
+  {
+    uint64_t ready = readyTime_;
+    uint64_t records = forwarded_ + duplicates_;
+    if (ready) records -= readyRecords_;
+    uint64_t dt = now() - (ready ? ready : startTime_);
+    return (dt > 0) ? uint32_t(records * 1000000000ULL / dt) : 0;
+  }
+
+  uint32_t getAverageLatency()  // in us
+  {
+    uint64_t n = forwarded_ + duplicates_;
+    return (n > 0) ? uint32_t(latencySum_ / n / 1000) : 0;
+  }
+
+private:
+  /* Private constant declerations (static) */
+  static const uint16_t DEFAULT_DEDUP_WINDOW = 1000;   // in ms
+  static const uint16_t DEFAULT_SCAN_TIME    = 5000;   // in ms
+  static const uint16_t POLL_TIMEOUT         = 50;     // in ms -> stop() latency
+  static const uint16_t SETUP_RETRY_TIME     = 1000;   // in ms
+  static const size_t QUEUE_SIZE             = 1024;   // has to be a power of two
+
+  /* bounded lock-free multi-producer queue (one consumer), see D. Vyukov */
+  struct queueCell_t
+  {
+    std::atomic<size_t> sequence;
+    gatewayRecord_t data;
+  };
+
+  class RecordQueue
+  {
+  public:
+    RecordQueue(size_t size) : cells_(size), mask_(size - 1)
+    {
+      for (size_t i = 0; i < size; i++) cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const gatewayRecord_t &data)
+    {
+      size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        queueCell_t &cell = cells_[pos & mask_];
+        intptr_t dif = intptr_t(cell.sequence.load(std::memory_order_acquire)) - intptr_t(pos);
+        if (dif == 0)
+        {
+          if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            cell.data = data;
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if (dif < 0) return false;   // full
+        else pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    bool pop(gatewayRecord_t &data)  // single consumer
+    {
+      queueCell_t &cell = cells_[dequeuePos_ & mask_];
+      intptr_t dif = intptr_t(cell.sequence.load(std::memory_order_acquire)) - intptr_t(dequeuePos_ + 1);
+      if (dif < 0) return false;   // empty
+      data = cell.data;
+      cell.sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+      dequeuePos_++;
+      return true;
+    }
+
+  private:
+    std::vector<queueCell_t> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) size_t dequeuePos_ = 0;
+  };
+
+  /* Private member data */
+  recordCallback_t callback_;
+  void *context_;
+  uint16_t dedupWindow_;
+  uint16_t scanTime_;
+  std::vector<HM11_PosixSerial *> modules_;
+  std::vector<std::thread> workers_;
+  std::thread aggregator_;
+  std::atomic<bool> running_{false};
+  std::atomic<bool> aggregating_{false};
+  RecordQueue queue_;
+  uint64_t startTime_ = 0;
+  std::atomic<size_t> setUp_{0};          // modules which have been set up once
+  std::atomic<uint64_t> readyTime_{0};    // all modules set up, 0 -> not yet
+  std::atomic<uint64_t> readyRecords_{0}; // aggregated records until then
+
+  // statistics (written by the aggregator, counters by the workers)
+  std::atomic<uint64_t> received_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> setupFailures_{0};
+  std::atomic<uint64_t> forwarded_{0};
+  std::atomic<uint64_t> duplicates_{0};
+  std::atomic<uint64_t> latencySum_{0};
+  std::atomic<uint64_t> latencyMax_{0};
+
+  /* Private member functions */
+  static uint64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  bool setup(HM11_PosixSerial *ble)  // retries until the module answers or stop()
+  {
+    while (running_)
+    {
+      if (ble->begin() && ble->setupAsIBeaconDetector() == HM11::STATUS_OK) return true;
+      setupFailures_++;
+      for (uint16_t t = 0; t < SETUP_RETRY_TIME && running_; t += POLL_TIMEOUT)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT));
+      }
+    }
+    return false;
+  }
+
+  void scan(uint8_t module)  // I/O thread of one module
+  {
+    HM11_PosixSerial *ble = modules_[module];
+    if (!setup(ble)) return;
+    if (++setUp_ == modules_.size())
+    {
+      readyRecords_ = forwarded_ + duplicates_;
+      readyTime_ = now();
+    }
+
+    gatewayRecord_t entry;
+    entry.module = module;
+    while (running_)
+    {
+      if (ble->getError() != 0 && !setup(ble)) return;   // e.g. unplugged -> begin() reopens the device
+      if (!ble->isScanning()) ble->startIBeaconScan(scanTime_);
+      struct pollfd pfd = {ble->getFileDescriptor(), POLLIN, 0};   // changes with a reopen
+      poll(&pfd, 1, POLL_TIMEOUT);
+
+      HM11::scanState_t state;
+      while ((state = ble->pollIBeaconScan(&entry.record)) == HM11::SCAN_RECORD)
+      {
+        entry.timestamp = now();
+        received_++;
+        if (!queue_.push(entry)) dropped_++;
+      }
+    }
+    ble->stopScan();
+  }
+
+  void aggregate()  // aggregation thread
+  {
+    std::unordered_map<uint64_t, uint64_t> lastSeen;   // mac -> timestamp
+    const int64_t window = int64_t(dedupWindow_) * 1000000LL;
+    uint64_t lastPrune = now();
+    gatewayRecord_t entry;
+
+    for (;;)
+    {
+      if (!queue_.pop(entry))
+      {
+        if (!aggregating_) break;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        continue;
+      }
+
+      uint64_t t = now();
+      uint64_t latency = t - entry.timestamp;
+      latencySum_ += latency;
+      if (latency > latencyMax_) latencyMax_ = latency;
+
+      /* forget the iBeacons which have not been seen within the window */
+      if (int64_t(t - lastPrune) >= window)
+      {
+        for (std::unordered_map<uint64_t, uint64_t>::iterator it = lastSeen.begin(); it != lastSeen.end();)
+        {
+          if (int64_t(t - it->second) >= window) it = lastSeen.erase(it);
+          else ++it;
+        }
+        lastPrune = t;
+      }
+
+      uint64_t mac = 0;
+      for (uint8_t i = 0; i < sizeof(entry.record.mac); i++) mac = (mac << 8) | entry.record.mac[i];
+      std::unordered_map<uint64_t, uint64_t>::iterator it = lastSeen.find(mac);
+      if (it != lastSeen.end())
+      {
+        /* signed: the records of several modules arrive out of order */
+        int64_t age = int64_t(entry.timestamp - it->second);
+        if (age < window && age > -window)
+        {
+          duplicates_++;
+          continue;
+        }
+        if (age > 0) it->second = entry.timestamp;
+      }
+      else lastSeen[mac] = entry.timestamp;
+      forwarded_++;
+      if (callback_ != NULL) callback_(&entry, context_);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*******************************************************************************
+* \file    HM11_Manager.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Manager.h"
+
+#if HM11_FEATURE_DETECTOR  // the manager schedules scans
+
+/* ======================= Module constant declaration ====================== */
+
+/* ======================== Module macro declaration ======================== */
+
+/* ====================== Module class instantiations ======================= */
+
+/* ======================== Public member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     addModule
+  * \brief  adds a module which has already been started with begin()
+  *
+  * \param  module    HM11 instance
+  * \param  mode      see enumerator in the header file
+  * \param  scanTime  max time of one scan in ms (MODULE_SCANNER only)
+  * \return index of the module or -1 if there is no space left
+  --------------------------------------------------------------------------- */
+  int8_t HM11_Manager::addModule(HM11 &module, moduleMode_t mode, uint16_t scanTime)
+  {
+    if (moduleCount_ >= HM11_MANAGER_MAX_MODULES) return -1;
+    uint8_t i = moduleCount_++;
+    modules_[i] = &module;
+    modes_[i] = mode;
+    scanTimes_[i] = scanTime;
+    scanStartMillis_[i] = 0;
+    stats_[i] = moduleStats_t();
+    if (mode == MODULE_SCANNER) modules_[i]->setupAsIBeaconDetector();
+    return i;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setMode
+  * \brief  changes the mode of a module (a running scan gets aborted)
+  *
+  * \param  module  module index
+  * \param  mode    see enumerator in the header file
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11_Manager::setMode(uint8_t module, moduleMode_t mode)
+  {
+    if (module >= moduleCount_ || modes_[module] == mode) return;
+    if (modules_[module]->isScanning())
+    {
+      modules_[module]->stopScan();
+      stats_[module].scanTime += modules_[module]->getMillis() - scanStartMillis_[module];
+    }
+    modes_[module] = mode;
+    if (mode == MODULE_SCANNER) modules_[module]->setupAsIBeaconDetector();
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     poll
+  * \brief  serves all modules once (round robin), call this in the main loop
+  --------------------------------------------------------------------------- */
+  void HM11_Manager::poll()
+  {
+    for (uint8_t i = 0; i < moduleCount_; i++)
+    {
+      if (modes_[i] == MODULE_SCANNER) pollModule(i);
+    }
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getModuleCount
+  * \brief  returns the number of added modules
+  *
+  * \return number of modules
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Manager::getModuleCount()
+  {
+    return moduleCount_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getStats
+  * \brief  returns the scan statistics of a module
+  *
+  * \param  module  module index
+  * \return statistics or NULL if the index is invalid
+  --------------------------------------------------------------------------- */
+  const HM11_Manager::moduleStats_t *HM11_Manager::getStats(uint8_t module)
+  {
+    return (module < moduleCount_) ? &stats_[module] : NULL;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getCoverage
+  * \brief  returns the scan coverage of a module
+  *
+  * \param  module  module index
+  * \return received records per minute of scanning
+  --------------------------------------------------------------------------- */
+  uint16_t HM11_Manager::getCoverage(uint8_t module)
+  {
+    if (module >= moduleCount_ || stats_[module].scanTime == 0) return 0;
+    return (stats_[module].records * 60000UL) / stats_[module].scanTime;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getCommandCount
+  * \brief  returns the number of AT commands sent by a module
+  *
+  * \param  module  module index
+  * \return number of AT commands
+  --------------------------------------------------------------------------- */
+  uint32_t HM11_Manager::getCommandCount(uint8_t module)
+  {
+    return (module < moduleCount_) ? modules_[module]->getCommandCount() : 0;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getCommandThroughput
+  * \brief  returns the command throughput of a module
+  *
+  * \param  module  module index
+  * \return AT commands per second of command time
+  --------------------------------------------------------------------------- */
+  uint16_t HM11_Manager::getCommandThroughput(uint8_t module)
+  {
+    if (module >= moduleCount_) return 0;
+    uint32_t commandTime = modules_[module]->getCommandTime();
+    return (commandTime > 0) ? (modules_[module]->getCommandCount() * 1000UL) / commandTime : 0;
+  }
+
+/* ======================= Private member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     pollModule
+  * \brief  (re)starts and processes the scan of a module without blocking
+  *
+  * \param  module  module index
+  --------------------------------------------------------------------------- */
+  void HM11_Manager::pollModule(uint8_t module)
+  {
+    HM11 *ble = modules_[module];
+
+    if (!ble->isScanning())
+    {
+      if (ble->startIBeaconScan(scanTimes_[module])) scanStartMillis_[module] = ble->getMillis();
+      return;
+    }
+
+    /* hand over at most one record per poll to keep the modules interleaved */
+    HM11::iBeaconRecord_t record;
+    switch (ble->pollIBeaconScan(&record))
+    {
+      case HM11::SCAN_RECORD:
+        stats_[module].records++;
+        if (callback_ != NULL) callback_(module, &record);
+        break;
+      case HM11::SCAN_DONE:
+        stats_[module].scans++;
+        stats_[module].scanTime += ble->getMillis() - scanStartMillis_[module];
+        break;
+      case HM11::SCAN_FAILED:
+        stats_[module].failedScans++;
+        stats_[module].scanTime += ble->getMillis() - scanStartMillis_[module];
+        break;
+      default: break;
+    }
+  }
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef _LIB_HM11_Manager_H_
+#define _LIB_HM11_Manager_H_
+/*******************************************************************************
+* \file    HM11_Manager.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Drives several HM11 modules cooperatively
+*
+* \section DESCRIPTION
+* The manager owns up to HM11_MANAGER_MAX_MODULES HM11 instances (e.g. one
+* HM11_SoftwareSerial0..3 each) and interleaves their non-blocking scans.
+* Call poll() as often as possible in the main loop. Records of all scanning
+* modules are merged into one callback stream. Passive modules (advertising
+* or carrying data) are left untouched by the manager.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+#ifndef HM11_MANAGER_MAX_MODULES
+  #define HM11_MANAGER_MAX_MODULES  4
+#endif
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Manager
+{
+public:
+  /* Public member typedefs */
+  typedef enum : uint8_t
+  {
+    MODULE_PASSIVE  = 0,  // not touched by the manager (advertising, data)
+    MODULE_SCANNER  = 1   // scans continuously for iBeacons
+  } moduleMode_t;
+
+  typedef struct
+  {
+    uint16_t scans;           // completed scans
+    uint16_t failedScans;     // timeouted scans
+    uint32_t records;         // received records
+    uint32_t scanTime;        // total time spent scanning in ms
+  } moduleStats_t;
+
+  typedef void (*recordCallback_t)(uint8_t module, const HM11::iBeaconRecord_t *record);
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Manager(recordCallback_t callback) : callback_(callback) {};
+  ~HM11_Manager() {};
+  // Example instantation:
+  // HM11_Manager manager(onRecord);
+  // manager.addModule(BLE0, HM11_Manager::MODULE_SCANNER);
+  // manager.addModule(BLE1, HM11_Manager::MODULE_PASSIVE);
+
+  /* Public member functions */
+  int8_t addModule(HM11 &module, moduleMode_t mode, uint16_t scanTime = 5000);  // returns the module index or -1
+  void setMode(uint8_t module, moduleMode_t mode);
+  void poll();
+  uint8_t getModuleCount();
+  const moduleStats_t *getStats(uint8_t module);
+  uint16_t getCoverage(uint8_t module);             // records per minute of scanning
+  uint32_t getCommandCount(uint8_t module);
+  uint16_t getCommandThroughput(uint8_t module);    // commands per second of command time
+
+private:
+  /* Private constant declerations (static) */
+  //...
+
+  /* Private member data */
+  recordCallback_t callback_;
+  uint8_t moduleCount_ = 0;
+  HM11 *modules_[HM11_MANAGER_MAX_MODULES];
+  moduleMode_t modes_[HM11_MANAGER_MAX_MODULES];
+  uint16_t scanTimes_[HM11_MANAGER_MAX_MODULES];
+  uint32_t scanStartMillis_[HM11_MANAGER_MAX_MODULES];
+  moduleStats_t stats_[HM11_MANAGER_MAX_MODULES];
+
+  /* Private member functions */
+  void pollModule(uint8_t module);
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*******************************************************************************
+* \file    HM11_Poller.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Poller.h"
+
+#if HM11_FEATURE_CONNECTION  // the poller connects to the peers
+
+/* ======================= Module constant declaration ====================== */
+
+/* ======================== Module macro declaration ======================== */
+
+/* ====================== Module class instantiations ======================= */
+
+/* ======================== Public member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     addPeer
+  * \brief  adds a peripheral to the polling list
+  *
+  * \param  mac   MAC address (12 hex digits)
+  * \return index of the peer or -1 if the list is full or the MAC is invalid
+  --------------------------------------------------------------------------- */
+  int8_t HM11_Poller::addPeer(const char *mac)
+  {
+    if (peerCount_ >= HM11_POLLER_MAX_PEERS || !HM11::isValidMacAddress(mac)) return -1;
+    strcpy(peers_[peerCount_], mac);
+    memset(&peerStats_[peerCount_], 0, sizeof(peerStats_t));
+    return int8_t(peerCount_++);
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getPeerCount
+  * \brief  returns the number of peers in the polling list
+  *
+  * \return number of peers
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Poller::getPeerCount()
+  {
+    return peerCount_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setRequest
+  * \brief  sets the request which is sent to every peer
+  *
+  * \param  payload   request data
+  * \param  length    max. HM11_POLLER_MAX_PAYLOAD bytes
+  * \return true if the request fits into a frame
+  --------------------------------------------------------------------------- */
+  bool HM11_Poller::setRequest(const uint8_t *payload, uint8_t length)
+  {
+    if (length > HM11_POLLER_MAX_PAYLOAD) return false;
+    requestLength_ = buildFrame(payload, length, request_);
+    return true;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     pollPeer
+  * \brief  connects to a peer, exchanges the request and the response and
+  *         disconnects again (blocking)
+  *
+  * \param  peer    index of the peer (see addPeer)
+  * \return STATUS_OK if a valid response has been received, STATUS_BUSY if
+  *         the TX queue did not take the whole request (e.g. data of the
+  *         application), STATUS_TIMEOUT if no valid response arrived
+  --------------------------------------------------------------------------- */
+  HM11::status_t HM11_Poller::pollPeer(uint8_t peer)
+  {
+    if (peer >= peerCount_) return HM11::STATUS_INVALID;
+    uint32_t startMillis = ble_.getMillis();
+
+    HM11::status_t status = ble_.connectToMacAddress(String(peers_[peer]), true, connectTimeout_);
+    if (status != HM11::STATUS_OK)
+    {
+      peerStats_[peer].connectFailures++;
+      updatePeerStats(peer, startMillis);
+      return status;
+    }
+
+    if (ble_.write(request_, requestLength_) != requestLength_)
+    {
+      /* a partial frame would never be answered, disconnect() discards it */
+      ble_.disconnect();
+      peerStats_[peer].writeFailures++;
+      updatePeerStats(peer, startMillis);
+      return HM11::STATUS_BUSY;
+    }
+    ble_.flushTx();
+    responsePos_ = 0;
+    status = HM11::STATUS_TIMEOUT;
+    uint32_t ms = ble_.getMillis();
+    while ((ble_.getMillis() - ms) < responseTimeout_ && ble_.getLinkState() == HM11::LINK_CONNECTED)
+    {
+      ble_.pollTx();
+      int16_t b = ble_.readData();
+      if (b >= 0 && parseResponse(uint8_t(b)))
+      {
+        status = HM11::STATUS_OK;
+        break;
+      }
+    }
+    ble_.disconnect();
+
+    if (status == HM11::STATUS_OK)
+    {
+      peerStats_[peer].polls++;
+      if (callback_ != NULL) callback_(peer, response_, responseLength_, context_);
+    }
+    else peerStats_[peer].timeouts++;
+    updatePeerStats(peer, startMillis);
+    return status;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     pollCycle
+  * \brief  polls all peers once
+  *
+  * \return number of peers which answered
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Poller::pollCycle()
+  {
+    uint32_t startMillis = ble_.getMillis();
+    uint8_t answered = 0;
+    for (uint8_t i = 0; i < peerCount_; i++)
+    {
+      if (pollPeer(i) == HM11::STATUS_OK) answered++;
+    }
+
+    uint32_t dt = ble_.getMillis() - startMillis;
+    cycleStats_.cycles++;
+    cycleStats_.lastTime = dt;
+    cycleStats_.timeSum += dt;
+    if (dt > cycleStats_.maxTime) cycleStats_.maxTime = dt;
+    return answered;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getPeerStats
+  * \brief  returns the exchange statistics of a peer
+  *
+  * \param  peer    index of the peer (see addPeer)
+  * \return peer statistics (NULL if the index is invalid)
+  --------------------------------------------------------------------------- */
+  const HM11_Poller::peerStats_t *HM11_Poller::getPeerStats(uint8_t peer)
+  {
+    return (peer < peerCount_) ? &peerStats_[peer] : NULL;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getCycleStats
+  * \brief  returns the statistics of the complete cycles
+  *
+  * \return cycle statistics
+  --------------------------------------------------------------------------- */
+  const HM11_Poller::cycleStats_t *HM11_Poller::getCycleStats()
+  {
+    return &cycleStats_;
+  }
+
+/* ========================= Public class Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     buildFrame
+  * \brief  frames a payload (request of the poller or response of a peer)
+  *
+  * \param  payload   data
+  * \param  length    max. HM11_POLLER_MAX_PAYLOAD bytes
+  * \param  out       output buffer of at least length + 3 bytes
+  * \return frame length in bytes
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Poller::buildFrame(const uint8_t *payload, uint8_t length, uint8_t *out)
+  {
+    uint8_t check = length;
+    out[0] = FRAME_START;
+    out[1] = length;
+    for (uint8_t i = 0; i < length; i++)
+    {
+      out[2 + i] = payload[i];
+      check ^= payload[i];
+    }
+    out[2 + length] = check;
+    return length + 3;
+  }
+
+/* ======================= Private member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     parseResponse
+  * \brief  parses one byte of the response frame
+  *
+  * \param  b   received byte
+  * \return true if a valid frame is complete (see response_)
+  --------------------------------------------------------------------------- */
+  bool HM11_Poller::parseResponse(uint8_t b)
+  {
+    if (responsePos_ == 0)
+    {
+      if (b == FRAME_START) responsePos_ = 1;
+      return false;
+    }
+    if (responsePos_ == 1)
+    {
+      if (b > HM11_POLLER_MAX_PAYLOAD) {responsePos_ = 0; return false;}
+      responseLength_ = b;
+      responseCheck_ = b;
+      responsePos_ = 2;
+      return false;
+    }
+    if (responsePos_ - 2 < responseLength_)
+    {
+      response_[responsePos_ - 2] = b;
+      responseCheck_ ^= b;
+      responsePos_++;
+      return false;
+    }
+    responsePos_ = 0;
+    return b == responseCheck_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     updatePeerStats
+  * \brief  updates the exchange time of a peer
+  *
+  * \param  peer          index of the peer
+  * \param  startMillis   start of the exchange
+  --------------------------------------------------------------------------- */
+  void HM11_Poller::updatePeerStats(uint8_t peer, uint32_t startMillis)
+  {
+    uint32_t dt = ble_.getMillis() - startMillis;
+    uint16_t t = (dt < 0xFFFF) ? uint16_t(dt) : 0xFFFF;
+    peerStats_[peer].lastTime = t;
+    peerStats_[peer].timeSum += t;
+    if (t > peerStats_[peer].maxTime) peerStats_[peer].maxTime = t;
+  }
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef _LIB_HM11_Poller_H_
+#define _LIB_HM11_Poller_H_
+/*******************************************************************************
+* \file    HM11_Poller.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Time-multiplexed polling of several peripherals from one central
+*
+* \section DESCRIPTION
+* The HM11 holds one connection at a time. The poller cycles through a list
+* of peers: connect (connectToMacAddress), send the request frame, wait for
+* the response frame, disconnect. The role is configured once by the first
+* connect and kept in the shadow afterwards, disconnect() drops the link
+* with an "AT" -> no resets between the peers.
+* Frame: 0x7E, payload length, payload (max. HM11_POLLER_MAX_PAYLOAD bytes),
+* XOR of the length and the payload -> one BLE packet in each direction.
+* The peripherals build their response with buildFrame().
+* The stats report the exchange time per peer and the time of a complete
+* cycle -> the number of peers one collector can serve within a period.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+#ifndef HM11_POLLER_MAX_PEERS
+  #define HM11_POLLER_MAX_PEERS    20
+#endif
+#ifndef HM11_POLLER_MAX_PAYLOAD
+  #define HM11_POLLER_MAX_PAYLOAD  16   // frame = payload + 3 bytes
+#endif
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Poller
+{
+public:
+  /* Public member typedefs */
+  typedef struct
+  {
+    uint16_t polls;           // successful exchanges
+    uint16_t connectFailures; // peer not reachable
+    uint16_t writeFailures;   // connected, but the request did not fit into the TX queue
+    uint16_t timeouts;        // connected, but no valid response
+    uint16_t lastTime;        // in ms, connect -> disconnected
+    uint16_t maxTime;         // in ms
+    uint32_t timeSum;         // in ms
+  } peerStats_t;
+
+  typedef struct
+  {
+    uint16_t cycles;          // completed pollCycle() calls
+    uint32_t lastTime;        // in ms, all peers once
+    uint32_t maxTime;         // in ms
+    uint32_t timeSum;         // in ms
+  } cycleStats_t;
+
+  typedef void (*responseCallback_t)(uint8_t peer, const uint8_t *payload, uint8_t length, void *context);
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Poller(HM11 &ble, responseCallback_t callback, void *context = NULL,
+    uint16_t connectTimeout = DEFAULT_CONNECT_TIMEOUT, uint16_t responseTimeout = DEFAULT_RESPONSE_TIMEOUT) :
+    ble_(ble), callback_(callback), context_(context),
+    connectTimeout_(connectTimeout), responseTimeout_(responseTimeout) {};
+  ~HM11_Poller() {};
+  // Example instantation:
+  // HM11_Poller poller(BLE, onResponse);
+  // poller.addPeer("00078003135A");
+  // poller.setRequest(request, sizeof(request));
+  // poller.pollCycle();   // e.g. once a minute
+
+  /* Public member functions */
+  int8_t addPeer(const char *mac);   // 12 hex digits, returns the index (-1 -> list full or invalid MAC)
+  uint8_t getPeerCount();
+  bool setRequest(const uint8_t *payload, uint8_t length);  // sent to every peer
+  HM11::status_t pollPeer(uint8_t peer);  // one exchange, blocking (STATUS_BUSY -> TX queue full)
+  uint8_t pollCycle();                    // all peers once, returns the number of answering peers
+  const peerStats_t *getPeerStats(uint8_t peer);
+  const cycleStats_t *getCycleStats();
+
+  /* Public class functions (static) */
+  static uint8_t buildFrame(const uint8_t *payload, uint8_t length, uint8_t *out);  // out: length + 3 bytes, returns the frame length
+
+private:
+  /* Private constant declerations (static) */
+  static const uint16_t DEFAULT_CONNECT_TIMEOUT  = 3000;   // in ms
+  static const uint16_t DEFAULT_RESPONSE_TIMEOUT = 500;    // in ms
+  static const uint8_t FRAME_START               = 0x7E;
+
+  /* Private member data */
+  HM11 &ble_;
+  responseCallback_t callback_;
+  void *context_;
+  uint16_t connectTimeout_;
+  uint16_t responseTimeout_;
+  char peers_[HM11_POLLER_MAX_PEERS][13];
+  uint8_t peerCount_ = 0;
+  peerStats_t peerStats_[HM11_POLLER_MAX_PEERS];
+  cycleStats_t cycleStats_ = {0, 0, 0, 0};
+  uint8_t request_[HM11_POLLER_MAX_PAYLOAD + 3];
+  uint8_t requestLength_ = 0;
+
+  // response parser
+  uint8_t response_[HM11_POLLER_MAX_PAYLOAD];
+  uint8_t responsePos_ = 0;     // 0: waiting for FRAME_START, 1: length, then payload, checksum
+  uint8_t responseLength_ = 0;
+  uint8_t responseCheck_ = 0;
+
+  /* Private member functions */
+  bool parseResponse(uint8_t b);  // returns true if a valid frame is complete
+  void updatePeerStats(uint8_t peer, uint32_t startMillis);
+};
+
+#endif
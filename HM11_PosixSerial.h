@@ -0,0 +1,181 @@
+#ifndef _LIB_HM11_PosixSerial_H_
+#define _LIB_HM11_PosixSerial_H_
+/*******************************************************************************
+* \file    HM11_PosixSerial.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   POSIX (termios) serial implementation for the HM11
+*
+* \section DESCRIPTION
+* Instantiate this class if you want to control the HM11 from a Linux host
+* (e.g. a gateway with the HM11 on a USB-UART adapter). The library itself
+* still needs an Arduino compatible core (Arduino.h with String) on the host,
+* extras/host/Arduino.h is one.
+* The tty is opened non-blocking, waits for data use poll() instead of
+* busy loops and the time base is CLOCK_MONOTONIC. The EN and RESET pins
+* are not wired on such adapters -> they are mapped to dummy shadow bytes.
+* An I/O error (e.g. EIO after unplugging the adapter) or a write which
+* does not get rid of a byte within WRITE_TIMEOUT is stored (getError())
+* instead of retried, the next begin() reopens the device.
+* Any tty works, so a pseudo-terminal (pty) driven by a scripted fake
+* module can be used instead of real hardware (see extras/test).
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_PosixSerial : public HM11
+{
+public:
+  /* Public member typedefs */
+  //...
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_PosixSerial(const char *device) :
+    HM11(&pins_[0], 0, &pins_[1], 0, &pins_[2], 0, &pins_[3], 0),
+    device_(device) {};
+  ~HM11_PosixSerial() {BLESerial_end();};
+  // Example instantation:
+  // HM11_PosixSerial BLE("/dev/ttyUSB0");
+
+  /* Public member functions */
+  int getFileDescriptor() {return fd_;}  // e.g. to add the port to an epoll set
+  int getError() {return error_;}        // errno of the last failed I/O (0 -> none), begin() reopens
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t RX_BUFFER_SIZE = 64;  // in bytes
+  static const uint16_t WRITE_TIMEOUT = 1000;  // in ms without progress -> ETIMEDOUT
+
+  /* Private member data */
+  const char *device_;
+  volatile uint8_t pins_[4] = {0, 0, 0, 0};  // rxd, txd, en, rst shadow
+  int fd_ = -1;
+  int error_ = 0;
+  uint8_t rxBuffer_[RX_BUFFER_SIZE];
+  uint8_t rxHead_ = 0;
+  uint8_t rxTail_ = 0;
+
+protected:
+  /* Protected member functions (transport, can be tapped by HM11_Trace) */
+  void BLESerial_begin(int32_t baudrate)
+  {
+    if (error_ != 0) BLESerial_end();   // e.g. unplugged -> reopen
+    if (fd_ < 0) fd_ = ::open(device_, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd_ < 0) {error_ = errno; return;}
+    error_ = 0;
+
+    struct termios tty;
+    if (tcgetattr(fd_, &tty) != 0) {error_ = errno; return;}
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);   // 8N1, no flow control
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    speed_t speed;
+    switch (baudrate)
+    {
+      case BAUDRATE1: speed = B19200; break;
+      case BAUDRATE2: speed = B38400; break;
+      case BAUDRATE3: speed = B57600; break;
+      case BAUDRATE4: speed = B115200; break;
+      default:        speed = B9600; break;
+    }
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tcsetattr(fd_, TCSANOW, &tty);
+    rxHead_ = rxTail_ = 0;
+  }
+  void BLESerial_end()
+  {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+  }
+  bool BLESerial_ready() {return true;}   // nothing to wait for, a failed open() is reported by getError()
+  uint16_t BLESerial_available()
+  {
+    /* refill the rx buffer without blocking */
+    if (rxHead_ == rxTail_ && fd_ >= 0)
+    {
+      ssize_t n = ::read(fd_, rxBuffer_, RX_BUFFER_SIZE);
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) error_ = errno;
+      rxHead_ = 0;
+      rxTail_ = (n > 0) ? uint8_t(n) : 0;
+    }
+    return rxTail_ - rxHead_;
+  }
+  void BLESerial_print(String str)
+  {
+    for (uint16_t i = 0; i < str.length(); i++) BLESerial_write(str[i]);
+  }
+  void BLESerial_write(uint8_t b)
+  {
+    if (fd_ < 0 || error_ != 0) return;
+    struct pollfd pfd = {fd_, POLLOUT, 0};
+    uint32_t ms = BLE_millis();
+    while (::write(fd_, &b, 1) != 1)
+    {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {error_ = errno; return;}   // e.g. EIO, ENXIO after unplugging
+      if ((BLE_millis() - ms) >= WRITE_TIMEOUT) {error_ = ETIMEDOUT; return;}
+      poll(&pfd, 1, 10);
+    }
+  }
+  int16_t BLESerial_read()
+  {
+    return BLESerial_available() ? rxBuffer_[rxHead_++] : -1;
+  }
+  void BLESerial_flush() {if (fd_ >= 0) tcdrain(fd_);}
+  bool BLESerial_wait(uint16_t timeout)
+  {
+    if (BLESerial_available()) return true;
+    if (fd_ < 0) return false;
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    return (poll(&pfd, 1, timeout) > 0) && BLESerial_available();
+  }
+  uint32_t BLE_millis()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint32_t(ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL);
+  }
+  void BLE_delay(uint32_t ms)
+  {
+    struct timespec ts = {time_t(ms / 1000), long((ms % 1000) * 1000000L)};
+    while (nanosleep(&ts, &ts) != 0);
+  }
+};
+
+#endif
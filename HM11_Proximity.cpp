@@ -0,0 +1,231 @@
+/*******************************************************************************
+* \file    HM11_Proximity.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Proximity.h"
+
+/* ======================= Module constant declaration ====================== */
+/* 1000 * 10^(k/20) for k = 0..20 dB */
+static const uint16_t POW10_TABLE[21] PROGMEM =
+{
+  1000, 1122, 1259, 1413, 1585, 1778, 1995, 2239, 2512, 2818, 3162,
+  3548, 3981, 4467, 5012, 5623, 6310, 7079, 7943, 8913, 10000
+};
+
+/* ======================== Module macro declaration ======================== */
+
+/* ====================== Module class instantiations ======================= */
+
+/* ======================== Public member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     setEwmaShift
+  * \brief  sets the smoothing factor of the EWMA filter
+  *
+  * \param  shift  alpha = 1/2^shift (0: no smoothing, max 7)
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11_Proximity::setEwmaShift(uint8_t shift)
+  {
+    ewmaShift_ = (shift > 7) ? 7 : shift;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     setKalmanNoise
+  * \brief  sets the noise variances of the Kalman filter
+  *
+  * \param  process      change of the real RSSI between two samples in 1/16 dB^2
+  * \param  measurement  noise of one RSSI sample in 1/16 dB^2 (must be > 0)
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11_Proximity::setKalmanNoise(uint16_t process, uint16_t measurement)
+  {
+    processNoise_ = process;
+    measurementNoise_ = (measurement > 0) ? measurement : 1;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     update
+  * \brief  adds one scan record to the filter of its beacon
+  *
+  * \param  record  record of the scan
+  * \return updated beacon
+  --------------------------------------------------------------------------- */
+  const HM11_Proximity::beacon_t *HM11_Proximity::update(const HM11::iBeaconRecord_t *record)
+  {
+    beacon_t *beacon = getEntry(record->mac);
+    beacon->major = record->major;
+    beacon->minor = record->minor;
+    beacon->measuredPower = record->measuredPower;
+    beacon->lastSeen = ble_.getMillis();
+    filter(beacon, record->rssi);
+    beacon->distance = estimateDistance(beacon->rssi, beacon->measuredPower, pathLoss_);
+    return beacon;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     find
+  * \brief  looks up a tracked beacon
+  *
+  * \param  mac  6 byte mac address
+  * \return beacon or NULL if it is not tracked
+  --------------------------------------------------------------------------- */
+  const HM11_Proximity::beacon_t *HM11_Proximity::find(const uint8_t *mac)
+  {
+    for (uint8_t i = 0; i < beaconCount_; i++)
+    {
+      if (memcmp(beacons_[i].mac, mac, sizeof(beacons_[i].mac)) == 0) return &beacons_[i];
+    }
+    return NULL;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getBeaconCount
+  * \brief  returns the number of tracked beacons
+  *
+  * \return number of beacons
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Proximity::getBeaconCount()
+  {
+    return beaconCount_;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     getBeacon
+  * \brief  returns a tracked beacon
+  *
+  * \param  index  0..getBeaconCount()-1
+  * \return beacon or NULL if the index is invalid
+  --------------------------------------------------------------------------- */
+  const HM11_Proximity::beacon_t *HM11_Proximity::getBeacon(uint8_t index)
+  {
+    return (index < beaconCount_) ? &beacons_[index] : NULL;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     clear
+  * \brief  forgets all beacons
+  --------------------------------------------------------------------------- */
+  void HM11_Proximity::clear()
+  {
+    beaconCount_ = 0;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     estimateDistance
+  * \brief  estimates the distance with the log-distance path loss model
+  *
+  * \param  rssi           RSSI in 1/256 dBm
+  * \param  measuredPower  RSSI at 1m in dBm
+  * \param  pathLoss       path loss exponent n in 1/10 (20: free space)
+  * \return distance in cm (saturates at 65535)
+  --------------------------------------------------------------------------- */
+  uint16_t HM11_Proximity::estimateDistance(int16_t rssi, int8_t measuredPower, uint8_t pathLoss)
+  {
+    if (pathLoss == 0) return 0;
+
+    /* d = 10^(loss / (10 * n)) = 10^(y / 20) with y = 20 * loss / (10 * n) in 1/256 dB */
+    int32_t y = ((int32_t(measuredPower) * 256 - rssi) * 20) / pathLoss;
+    bool closer = (y < 0);
+    if (closer) y = -y;
+
+    uint16_t dB = y >> 8;
+    uint8_t decades = dB / 20;
+    uint8_t k = dB % 20;
+    uint16_t lo = pgm_read_word(&POW10_TABLE[k]);
+    uint16_t hi = pgm_read_word(&POW10_TABLE[k + 1]);
+    uint32_t mantissa = lo + ((uint32_t(hi - lo) * uint8_t(y)) >> 8);   // 1000..10000
+
+    uint32_t cm;
+    if (closer)
+    {
+      cm = 100000UL / mantissa;
+      while (decades-- && cm > 0) cm /= 10;
+      return cm;
+    }
+    if (decades > 4) return UINT16_MAX;
+    cm = mantissa / 10;
+    while (decades--) cm *= 10;
+    return (cm > UINT16_MAX) ? UINT16_MAX : cm;
+  }
+
+/* ======================= Private member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     getEntry
+  * \brief  returns the entry of a beacon, a new one replaces the least
+  *         recently seen beacon if the table is full
+  *
+  * \param  mac  6 byte mac address
+  * \return beacon entry
+  --------------------------------------------------------------------------- */
+  HM11_Proximity::beacon_t *HM11_Proximity::getEntry(const uint8_t *mac)
+  {
+    beacon_t *beacon = (beacon_t *)find(mac);
+    if (beacon != NULL) return beacon;
+
+    if (beaconCount_ < HM11_PROXIMITY_MAX_BEACONS) beacon = &beacons_[beaconCount_++];
+    else
+    {
+      uint32_t ms = ble_.getMillis();
+      beacon = &beacons_[0];
+      for (uint8_t i = 1; i < beaconCount_; i++)
+      {
+        if ((ms - beacons_[i].lastSeen) > (ms - beacon->lastSeen)) beacon = &beacons_[i];
+      }
+    }
+    memcpy(beacon->mac, mac, sizeof(beacon->mac));
+    beacon->samples = 0;
+    return beacon;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     filter
+  * \brief  adds one RSSI sample to the filter of a beacon
+  *
+  * \param  beacon  beacon entry
+  * \param  sample  RSSI in dBm
+  * \return None
+  --------------------------------------------------------------------------- */
+  void HM11_Proximity::filter(beacon_t *beacon, int8_t sample)
+  {
+    int16_t z = int16_t(sample) * 256;
+    if (beacon->samples == 0)
+    {
+      beacon->rssi = z;
+      beacon->variance = measurementNoise_;
+      beacon->samples = 1;
+      return;
+    }
+    if (beacon->samples < UINT8_MAX) beacon->samples++;
+
+    int32_t error = int32_t(z) - beacon->rssi;
+    if (filter_ == FILTER_EWMA)
+    {
+      beacon->rssi += int16_t(error >> ewmaShift_);
+      return;
+    }
+
+    /* predict, then correct with the Kalman gain K = P / (P + R) in 1/256 */
+    uint32_t p = uint32_t(beacon->variance) + processNoise_;
+    if (p > UINT16_MAX) p = UINT16_MAX;
+    uint16_t gain = (p << 8) / (p + measurementNoise_);
+    beacon->rssi += int16_t((error * gain) >> 8);
+    beacon->variance = (p * (256 - gain)) >> 8;
+  }
@@ -0,0 +1,116 @@
+#ifndef _LIB_HM11_Proximity_H_
+#define _LIB_HM11_Proximity_H_
+/*******************************************************************************
+* \file    HM11_Proximity.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Per-beacon RSSI filter and distance estimation (fixed-point)
+*
+* \section DESCRIPTION
+* Feed every scan record into update(). The RSSI of each beacon is smoothed
+* incrementally with a 1-D Kalman filter or an EWMA, both without floating
+* point arithmetic. The distance is estimated from the measured power (RSSI
+* at 1m) and the filtered RSSI with the log-distance path loss model
+* d = 10^((measuredPower - rssi) / (10 * n)), the power of ten is looked up
+* in a table. Up to HM11_PROXIMITY_MAX_BEACONS beacons are tracked, the
+* least recently seen one gets replaced. lastSeen is taken from the clock of
+* the driver (getMillis()), so the replacement also works with the
+* simulated backends.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+#ifndef HM11_PROXIMITY_MAX_BEACONS
+  #define HM11_PROXIMITY_MAX_BEACONS  8
+#endif
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Proximity
+{
+public:
+  /* Public member typedefs */
+  typedef enum : uint8_t
+  {
+    FILTER_EWMA   = 0,  // rssi += (sample - rssi) / 2^shift
+    FILTER_KALMAN = 1   // 1-D Kalman filter with constant process noise
+  } filter_t;
+
+  typedef struct
+  {
+    uint8_t mac[6];
+    uint16_t major;
+    uint16_t minor;
+    int16_t rssi;             // filtered RSSI in 1/256 dBm
+    uint16_t variance;        // Kalman error variance in 1/16 dB^2
+    int8_t measuredPower;     // RSSI at 1m in dBm
+    uint8_t samples;          // saturates at 255
+    uint16_t distance;        // in cm
+    uint32_t lastSeen;        // in ms (driver clock)
+  } beacon_t;
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Proximity(HM11 &ble, filter_t filter = FILTER_KALMAN, uint8_t pathLoss = DEFAULT_PATH_LOSS) :
+    ble_(ble), filter_(filter), pathLoss_(pathLoss) {};
+  ~HM11_Proximity() {};
+  // Example instantation:
+  // HM11_Proximity proximity(BLE);
+  // proximity.update(&record);   // for every HM11::SCAN_RECORD
+
+  /* Public member functions */
+  void setEwmaShift(uint8_t shift);                          // alpha = 1/2^shift
+  void setKalmanNoise(uint16_t process, uint16_t measurement);  // in 1/16 dB^2
+  const beacon_t *update(const HM11::iBeaconRecord_t *record);
+  const beacon_t *find(const uint8_t *mac);
+  uint8_t getBeaconCount();
+  const beacon_t *getBeacon(uint8_t index);
+  void clear();
+  static uint16_t estimateDistance(int16_t rssi, int8_t measuredPower, uint8_t pathLoss = DEFAULT_PATH_LOSS);
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t DEFAULT_PATH_LOSS          = 20;   // path loss exponent n in 1/10 (free space)
+  static const uint8_t DEFAULT_EWMA_SHIFT         = 3;    // alpha = 1/8
+  static const uint16_t DEFAULT_PROCESS_NOISE     = 8;    // 0.5 dB^2
+  static const uint16_t DEFAULT_MEASUREMENT_NOISE = 256;  // 16 dB^2 -> 4 dB standard deviation
+
+  /* Private member data */
+  HM11 &ble_;
+  filter_t filter_;
+  uint8_t pathLoss_;
+  uint8_t ewmaShift_ = DEFAULT_EWMA_SHIFT;
+  uint16_t processNoise_ = DEFAULT_PROCESS_NOISE;
+  uint16_t measurementNoise_ = DEFAULT_MEASUREMENT_NOISE;
+  uint8_t beaconCount_ = 0;
+  beacon_t beacons_[HM11_PROXIMITY_MAX_BEACONS];
+
+  /* Private member functions */
+  beacon_t *getEntry(const uint8_t *mac);
+  void filter(beacon_t *beacon, int8_t sample);
+};
+
+#endif
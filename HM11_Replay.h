@@ -0,0 +1,204 @@
+#ifndef _LIB_HM11_Replay_H_
+#define _LIB_HM11_Replay_H_
+/*******************************************************************************
+* \file    HM11_Replay.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Deterministic replay of a UART trace (see HM11_Trace.h)
+*
+* \section DESCRIPTION
+* The replay backend plays the received bytes of a trace back to the library
+* with the original timing. Time is virtual: BLE_millis(), BLE_delay() and
+* BLESerial_wait() advance a clock in us instead of waiting, so a replay runs
+* as fast as the host allows and always takes the same path through the
+* parsers. Every transmitted byte is compared with the next TX byte of the
+* trace. A matching byte re-aligns the trace to the current virtual time, so
+* the responses follow the commands like they did on the field unit. The
+* first byte which differs (or which is sent while the trace expects a
+* received byte) ends the replay: no more bytes are received, so the
+* library fails with a timeout, and getDivergence() reports where the
+* library left the trace. The virtual clock is 32 bit in us, so a replay
+* may last up to ~71 minutes.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include "HM11_Trace.h"
+
+/* ==================== Global module constant declaration ================== */
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Replay : public HM11
+{
+public:
+  /* Public member typedefs */
+  typedef struct
+  {
+    uint32_t position;   // offset of the expected event in the trace
+    uint32_t event;      // index of the expected event (0: first event)
+    int16_t expected;    // TX byte of the trace, -1 if a received byte was due or the trace ended
+    uint8_t actual;      // byte sent by the library
+  } divergence_t;
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Replay(const uint8_t *trace, uint32_t length) :
+    HM11(&pins_[0], 0, &pins_[1], 0, &pins_[2], 0, &pins_[3], 0),
+    trace_(trace), length_(length) {rewind();};
+  ~HM11_Replay() {};
+  // Example instantation:
+  // HM11_Replay BLE(traceData, traceLength);
+
+  /* Public member functions */
+  bool isValid() {return valid_;}                 // header ok
+  bool isFinished() {return !hasEvent_ && !diverged_;}  // all events consumed
+  bool hasDiverged() {return diverged_;}
+  const divergence_t &getDivergence() {return divergence_;}  // first mismatching TX byte
+  uint32_t getMismatchCount() {return mismatches_;}  // TX bytes which differ from the trace (or follow a mismatch)
+  uint32_t getMicros() {return clock_;}           // virtual time
+
+  void rewind()
+  {
+    pos_ = 0;
+    eventPos_ = 0;
+    clock_ = 0;
+    offset_ = 0;
+    eventTime_ = 0;
+    mismatches_ = 0;
+    diverged_ = false;
+    valid_ = (length_ >= HM11_TRACE_HEADER_SIZE) && (trace_[0] == 'H') && (trace_[1] == 'M') &&
+      (trace_[2] == 'T') && (trace_[3] == HM11_TRACE_VERSION);
+    if (valid_) pos_ = HM11_TRACE_HEADER_SIZE;
+    eventIndex_ = 0;
+    nextEvent();
+  }
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t TICK = 10;  // virtual time of one BLE_millis() call in us -> polling loops progress
+
+  /* Private member data */
+  volatile uint8_t pins_[4] = {0, 0, 0, 0};  // rxd, txd, en, rst shadow
+  const uint8_t *trace_;
+  uint32_t length_;
+  uint32_t pos_;
+  uint32_t eventPos_;    // trace offset of the current event
+  uint32_t eventIndex_;  // consumed events
+  bool valid_;
+  bool hasEvent_;
+  bool eventTx_;
+  uint8_t eventData_;
+  uint32_t eventTime_;   // trace time of the current event in us
+  uint32_t clock_;       // virtual time in us
+  int32_t offset_;       // virtual time - trace time
+  uint32_t mismatches_;
+  bool diverged_;
+  divergence_t divergence_;
+
+  /* Private member functions */
+  void nextEvent()
+  {
+    hasEvent_ = false;
+    if (!valid_) return;
+    eventPos_ = pos_;
+
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    while (pos_ < length_ && shift < 35)
+    {
+      uint8_t b = trace_[pos_++];
+      value |= uint32_t(b & 0x7F) << shift;
+      shift += 7;
+      if (!(b & 0x80))
+      {
+        if (pos_ >= length_) return;   // truncated
+        eventTx_ = value & 1;
+        eventTime_ += value >> 1;
+        eventData_ = trace_[pos_++];
+        hasEvent_ = true;
+        return;
+      }
+    }
+  }
+
+  uint32_t eventClock() {return eventTime_ + offset_;}
+  bool rxReady() {return hasEvent_ && !diverged_ && !eventTx_ && int32_t(clock_ - eventClock()) >= 0;}
+
+  void BLESerial_begin(int32_t) {}
+  void BLESerial_end() {}
+  bool BLESerial_ready() {return true;}
+  uint16_t BLESerial_available() {return rxReady() ? 1 : 0;}
+  void BLESerial_print(String str)
+  {
+    for (uint16_t i = 0; i < str.length(); i++) BLESerial_write(str[i]);
+  }
+  void BLESerial_write(uint8_t b)
+  {
+    if (diverged_ || !hasEvent_ || !eventTx_ || eventData_ != b)
+    {
+      mismatches_++;
+      if (!diverged_)
+      {
+        diverged_ = true;
+        divergence_.position = eventPos_;
+        divergence_.event = eventIndex_;
+        divergence_.expected = (hasEvent_ && eventTx_) ? eventData_ : -1;
+        divergence_.actual = b;
+      }
+      return;
+    }
+    offset_ = int32_t(clock_ - eventTime_);   // re-align the responses to this command
+    eventIndex_++;
+    nextEvent();
+  }
+  int16_t BLESerial_read()
+  {
+    if (!rxReady()) return -1;
+    uint8_t b = eventData_;
+    eventIndex_++;
+    nextEvent();
+    return b;
+  }
+  void BLESerial_flush() {}
+  bool BLESerial_wait(uint16_t timeout)
+  {
+    if (rxReady()) return true;
+    uint32_t until = clock_ + uint32_t(timeout) * 1000UL;
+    if (hasEvent_ && !diverged_ && !eventTx_ && int32_t(until - eventClock()) >= 0)
+    {
+      clock_ = eventClock();
+      return true;
+    }
+    clock_ = until;
+    return false;
+  }
+  uint32_t BLE_millis()
+  {
+    clock_ += TICK;
+    return clock_ / 1000;
+  }
+  void BLE_delay(uint32_t ms) {clock_ += ms * 1000UL;}
+};
+
+#endif
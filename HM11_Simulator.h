@@ -0,0 +1,497 @@
+#ifndef _LIB_HM11_Simulator_H_
+#define _LIB_HM11_Simulator_H_
+/*******************************************************************************
+* \file    HM11_Simulator.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Virtual-time simulator of the HM11 module (host only)
+*
+* \section DESCRIPTION
+* Discrete-event model of the module behind the BLESerial_* interface. The
+* time is virtual (in us): BLE_millis(), BLE_delay() and BLESerial_wait()
+* advance the clock instead of waiting, so a complete begin(), scan or
+* connect sequence runs in milliseconds of wall clock while getMicros()
+* tells how long it would have taken with a real module.
+* Modelled are:
+* - the UART byte time of the baudrate (a wrong baudrate is not understood)
+* - the silence after which a command is processed and the processing delay
+* - the HW reset (RST pulse, boot time), AT+RESET and AT+RENEW phases of the
+*   empirical timing constants and comments in HM11.cpp
+* - ROLE, IMME and BAUD which get active with the next reset only
+* - a population of advertising devices (DISI, DISC, CON) which are reported
+*   with their first advertising event within the scan
+* - AT+SLEEP and the wake up by a string of more than 80 characters
+* - the connected peer, which can answer the transparent data (setPeerResponder)
+* - a hung firmware which does not answer at all (setHung)
+* The timing is configurable, the defaults follow the values measured so far.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <deque>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+class HM11_Simulator : public HM11
+{
+public:
+  /* Public member typedefs */
+  typedef struct
+  {
+    uint16_t commandGap;       // in us, silence after which a command is processed
+    uint16_t commandDelay;     // in us, processing until the response starts
+    uint8_t minResetPulse;     // in ms, shorter RST pulses are ignored
+    uint16_t bootTime;         // in ms, after the HW reset
+    uint16_t resetBusy;        // in ms, still answering after "AT+RESET" (~582ms)
+    uint16_t resetBoot;        // in ms, then down (~120ms)
+    uint16_t renewDown;        // in ms, down after "AT+RENEW" (~327ms)
+    uint16_t renewBusy;        // in ms, then answering (~250ms)
+    uint16_t renewBoot;        // in ms, then down again (~230ms)
+    uint16_t scanTime;         // in ms, duration of DISI and DISC
+    uint16_t connectTime;      // in ms, "AT+CON" -> "OK+CONN"
+    uint16_t connectFailTime;  // in ms, "AT+CON" -> "OK+CONNF" (unknown peer)
+  } timing_t;
+
+  typedef struct
+  {
+    const char *mac;           // 12 hex digits
+    const char *uuid;          // 32 hex digits, NULL -> no iBeacon (DISC only)
+    uint16_t major;
+    uint16_t minor;
+    int8_t measuredPower;      // in dBm
+    int8_t rssi;               // in dBm
+    uint16_t interval;         // advertising interval in ms
+    uint16_t offset;           // in ms, first advertising event (mod interval)
+    const char *name;          // reported by DISC with SHOW1
+    bool connectable;
+  } device_t;
+
+  typedef std::string (*peerResponder_t)(const std::string &mac, const std::string &data, void *context);  // reply of the connected peer ("" -> none)
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Simulator(const timing_t *timing = NULL) :
+    HM11(&pins_[0], 0, &pins_[1], 0, &pins_[2], 0, &pins_[3], 0),
+    timing_(timing ? *timing : defaultTiming()) {renew(); applySettings();};
+  ~HM11_Simulator() {};
+  // Example instantation:
+  // HM11_Simulator BLE;
+  // BLE.addDevice(beacon);
+  // BLE.begin();   // BLE.getMicros() -> virtual duration
+
+  /* Public member functions */
+  void addDevice(const device_t &device) {devices_.push_back(device);}
+  void setMacAddress(const char *mac) {mac_ = mac;}
+  void setFirmware(const char *version) {firmware_ = version;}  // "AT+VERS?" response, e.g. "HMSoft V540"
+  void setModuleBaudrate(baudrate_t baudrate)  // e.g. left over by a previous run
+  {
+    static const baudrate_t BAUDRATES[] = {BAUDRATE0, BAUDRATE1, BAUDRATE2, BAUDRATE3, BAUDRATE4};
+    for (uint8_t i = 0; i < 5; i++) if (BAUDRATES[i] == baudrate) baud_ = std::string(1, char('0' + i));
+    applySettings();
+  }
+  static const timing_t &defaultTiming()
+  {
+    static const timing_t TIMING = {2000, 5000, 6, 300, 582, 120, 327, 250, 230, 3000, 300, 10000};
+    return TIMING;
+  }
+  void setPeerResponder(peerResponder_t responder, void *context = NULL, uint16_t latency = 30)  // latency in ms
+  {
+    responder_ = responder; responderContext_ = context; responderLatency_ = latency;
+  }
+  void dropLink() {if (linkUp_) {linkUp_ = false; queue(clock_, "OK+LOST");}}
+  void sendFromPeer(const char *data) {if (linkUp_) queue(clock_, data);}
+  void sendFromModule(const char *data) {queue(clock_, data);}  // raw UART output, e.g. a notification split over time
+  void setHung(bool hung) {hung_ = hung;}      // firmware hangs: no command is processed, not even after a reset
+  void run(uint32_t ms) {BLE_delay(ms);}       // lets virtual time pass (e.g. idle periods)
+  uint64_t getMicros() {return clock_;}          // virtual time
+  uint32_t getModuleCommands() {return moduleCommands_;}  // commands processed by the module
+  uint32_t getModuleResets() {return moduleResets_;}
+  uint32_t getAirBytes() {return airBytes_;}     // bytes sent to the peer
+  bool isLinkUp() {return linkUp_;}
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t TICK = 10;  // virtual time of one BLE_millis() call in us -> polling loops progress
+  static const uint8_t MAX_WINDOWS = 2;   // AT+RENEW has two down phases
+
+  typedef struct
+  {
+    uint64_t time;             // in us, when the byte is completely received by the host
+    uint8_t data;
+  } output_t;
+
+  /* Private member data */
+  volatile uint8_t pins_[4] = {0, 0, 0, 0};  // rxd, txd, en, rst shadow
+  timing_t timing_;
+  std::vector<device_t> devices_;
+  std::string mac_ = "001122334455";
+  std::string firmware_ = "HMSoft V540";
+  uint64_t clock_ = 0;           // virtual time in us (BLE_millis() wraps like millis(), the clock does not)
+  uint32_t hostBaudrate_ = 0;
+  uint32_t moduleBaudrate_ = BAUDRATE0;
+  std::deque<output_t> output_;  // module -> host
+  std::string command_;          // host -> module (not processed yet)
+  uint64_t lastRxTime_ = 0;
+
+  // module state
+  bool inReset_ = true;          // RST low (pins_ are 0 at power-up)
+  uint64_t rstLowSince_ = 0;
+  uint64_t downFrom_[MAX_WINDOWS] = {0, 0};    // not answering in [from, until)
+  uint64_t downUntil_[MAX_WINDOWS] = {0, 0};
+  bool applyPending_ = false;    // settings get active at applyTime_
+  uint64_t applyTime_ = 0;
+  std::string baud_, role_, imme_;             // configured (active after a reset)
+  std::string settings_[16];                   // see settingNames()
+  char pio_[16] = {'0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0'};
+  bool master_ = false;          // active role
+  bool immediate_ = false;       // active work type (IMME1)
+  bool linkPending_ = false;     // "OK+CONN" (linkFound_) or "OK+CONNF" at linkTime_
+  bool linkFound_ = false;
+  uint64_t linkTime_ = 0;
+  bool linkUp_ = false;
+  bool sleeping_ = false;        // AT+SLEEP
+  bool hung_ = false;            // setHung()
+  std::string peer_;             // mac of the connected peer
+  peerResponder_t responder_ = NULL;
+  void *responderContext_ = NULL;
+  uint16_t responderLatency_ = 0;   // in ms
+
+  // statistics
+  uint32_t moduleCommands_ = 0;
+  uint32_t moduleResets_ = 0;
+  uint32_t airBytes_ = 0;
+
+  /* Private member functions */
+  static const char *const *settingNames()
+  {
+    static const char *const NAMES[16] = {"ADTY", "ADVI", "DELO", "IBE0", "IBE1", "IBE2", "IBE3", "IBEA",
+      "MARJ", "MINO", "MODE", "MPIO", "NAME", "POWE", "PWRM", "SHOW"};
+    return NAMES;
+  }
+
+  bool reached(uint64_t t) {return clock_ >= t;}
+  uint32_t byteTime() {return 10000000UL / moduleBaudrate_;}  // 8N1 -> 10 bits
+
+  bool isUp(uint64_t t)
+  {
+    if (inReset_ || getBit(pins_[2], 0)) return false;   // RST low or disabled
+    for (uint8_t i = 0; i < MAX_WINDOWS; i++)
+    {
+      if (t >= downFrom_[i] && t < downUntil_[i]) return false;
+    }
+    return true;
+  }
+
+  void renew()  // factory default
+  {
+    static const char *const DEFAULTS[16] = {"0", "9", "0", "74278BDA", "B6444520", "8F0C720E", "AF059935", "0",
+      "0xFFE0", "0xFFE1", "0", "000", "HMSoft", "2", "1", "0"};
+    for (uint8_t i = 0; i < 16; i++) settings_[i] = DEFAULTS[i];
+    baud_ = "0";
+    role_ = "0";
+    imme_ = "0";
+  }
+
+  void applySettings()  // reboot
+  {
+    static const uint32_t BAUDRATES[] = {BAUDRATE0, BAUDRATE1, BAUDRATE2, BAUDRATE3, BAUDRATE4};
+    uint8_t b = uint8_t(baud_[0] - '0');
+    moduleBaudrate_ = (b < 5) ? BAUDRATES[b] : uint32_t(BAUDRATE0);
+    master_ = (role_ == "1");
+    immediate_ = (imme_ == "1");
+    linkPending_ = false;
+    linkUp_ = false;
+    applyPending_ = false;
+  }
+
+  void reboot(uint64_t from, uint64_t until, uint8_t window)
+  {
+    downFrom_[window] = from;
+    downUntil_[window] = until;
+    applyPending_ = true;
+    applyTime_ = until;
+    moduleResets_++;
+  }
+
+  void sampleReset()  // RST pin
+  {
+    bool low = !getBit(pins_[3], 0);
+    if (low && !inReset_) {inReset_ = true; rstLowSince_ = clock_;}
+    if (!low && inReset_)
+    {
+      inReset_ = false;
+      if ((clock_ - rstLowSince_) < uint32_t(timing_.minResetPulse) * 1000UL) return;  // too short
+      output_.clear();
+      command_.clear();
+      sleeping_ = false;
+      applySettings();
+      moduleResets_++;
+      for (uint8_t i = 0; i < MAX_WINDOWS; i++) downFrom_[i] = downUntil_[i] = 0;
+      downFrom_[0] = clock_;
+      downUntil_[0] = clock_ + uint32_t(timing_.bootTime) * 1000UL;
+    }
+  }
+
+  void queue(uint64_t t, const std::string &data)
+  {
+    uint32_t bt = byteTime();
+    if (!output_.empty() && output_.back().time > t) t = output_.back().time;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+      t += bt;
+      output_t out = {t, uint8_t(data[i])};
+      output_.push_back(out);
+    }
+  }
+
+  void advance()  // processes everything up to the current virtual time
+  {
+    sampleReset();
+    if (applyPending_ && reached(applyTime_)) applySettings();
+    if (linkPending_ && reached(linkTime_))
+    {
+      linkPending_ = false;
+      linkUp_ = linkFound_;
+      queue(linkTime_, linkFound_ ? "OK+CONN" : "OK+CONNF");
+    }
+    uint64_t due = lastRxTime_ + timing_.commandGap;
+    if (!command_.empty() && reached(due))
+    {
+      std::string cmd;
+      cmd.swap(command_);
+      process(cmd, due);
+    }
+  }
+
+  uint64_t nextEventTime(uint64_t until)
+  {
+    uint64_t t = until;
+    if (!output_.empty() && output_.front().time < t) t = output_.front().time;
+    uint64_t due = lastRxTime_ + timing_.commandGap;
+    if (!command_.empty() && due < t) t = due;
+    if (linkPending_ && linkTime_ < t) t = linkTime_;
+    return t;
+  }
+
+  void process(const std::string &cmd, uint64_t t)
+  {
+    if (hung_) return;
+    if (linkUp_)
+    {
+      /* transparent while connected, "AT" disconnects */
+      if (cmd == "AT") {linkUp_ = false; queue(t, "OK+LOST");}
+      else
+      {
+        airBytes_ += cmd.size();
+        std::string reply = responder_ ? responder_(peer_, cmd, responderContext_) : std::string();
+        if (!reply.empty()) queue(t + uint32_t(responderLatency_) * 1000UL, reply);
+      }
+      return;
+    }
+    if (sleeping_)
+    {
+      /* only a long string wakes the module up */
+      if (cmd.size() > 80) {sleeping_ = false; queue(t, "OK+WAKE");}
+      return;
+    }
+    if (!isUp(t) || cmd.compare(0, 2, "AT") != 0) return;
+    linkPending_ = false;   // any command cancels the connecting
+    moduleCommands_++;
+    t += timing_.commandDelay;
+    if (cmd == "AT") {queue(t, "OK"); return;}
+    if (cmd.size() < 4 || cmd[2] != '+') return;
+
+    std::string verb = cmd.substr(3);
+    bool query = (verb[verb.size() - 1] == '?');
+    if (query) verb.erase(verb.size() - 1);
+
+    if (verb == "RESET")
+    {
+      queue(t, "OK+RESET");
+      reboot(t + uint32_t(timing_.resetBusy) * 1000UL, t + uint32_t(timing_.resetBusy + timing_.resetBoot) * 1000UL, 0);
+    }
+    else if (verb == "RENEW")
+    {
+      queue(t, "OK+RENEW");
+      renew();
+      uint64_t busy = t + uint32_t(timing_.renewDown) * 1000UL;
+      downFrom_[0] = t + 1000UL;   // after the response
+      downUntil_[0] = busy;
+      reboot(busy + uint32_t(timing_.renewBusy) * 1000UL, busy + uint32_t(timing_.renewBusy + timing_.renewBoot) * 1000UL, 1);
+    }
+    else if (verb == "ADDR" && query) queue(t, "OK+ADDR:" + mac_);
+    else if (verb == "VERS" && query) queue(t, firmware_);
+    else if (verb == "SLEEP") {queue(t, "OK+SLEEP"); sleeping_ = true;}
+    else if (verb == "DISI" && query) scan(t, true);
+    else if (verb == "DISC" && query) scan(t, false);
+    else if (verb.compare(0, 3, "CON") == 0 && !query) connect(t, verb.substr(3));
+    else if (verb.compare(0, 3, "PIO") == 0 && verb.size() >= 4)
+    {
+      std::string pin = verb.substr(3, 1);
+      if (!query && verb.size() == 5) pio_[hexValue(pin[0])] = verb[4];
+      queue(t, "OK+PIO" + pin + ":" + std::string(1, pio_[hexValue(pin[0])]));
+    }
+    else if (verb.compare(0, 4, "BAUD") == 0) setting(t, baud_, verb.substr(4), query);
+    else if (verb.compare(0, 4, "ROLE") == 0) setting(t, role_, verb.substr(4), query);
+    else if (verb.compare(0, 4, "IMME") == 0) setting(t, imme_, verb.substr(4), query);
+    else
+    {
+      for (uint8_t i = 0; i < 16; i++)
+      {
+        if (verb.compare(0, 4, settingNames()[i]) == 0) {setting(t, settings_[i], verb.substr(4), query); return;}
+      }
+      queue(t, "ERROR");
+    }
+  }
+
+  void setting(uint64_t t, std::string &value, const std::string &arg, bool query)
+  {
+    if (!query) value = arg;
+    queue(t, (query ? "OK+Get:" : "OK+Set:") + value);
+  }
+
+  void scan(uint64_t t, bool iBeacons)
+  {
+    if (!master_ || !immediate_) {queue(t, "ERROR"); return;}
+    queue(t, iBeacons ? "OK+DISIS" : "OK+DISCS");
+
+    /* report every device with its first advertising event within the scan */
+    std::vector<std::pair<uint64_t, size_t> > events;
+    for (size_t i = 0; i < devices_.size(); i++)
+    {
+      if (iBeacons && devices_[i].uuid == NULL) continue;
+      uint16_t interval = devices_[i].interval ? devices_[i].interval : 1;
+      uint32_t first = devices_[i].offset % interval;
+      if (first < timing_.scanTime) events.push_back(std::make_pair(t + first * 1000UL, i));
+    }
+    for (size_t i = 1; i < events.size(); i++)   // insertion sort by time
+    {
+      for (size_t j = i; j > 0 && events[j].first < events[j - 1].first; j--) std::swap(events[j], events[j - 1]);
+    }
+    uint8_t show = uint8_t(settings_[15][0] - '0');
+    for (size_t i = 0; i < events.size(); i++)
+    {
+      const device_t &d = devices_[events[i].second];
+      char line[96];
+      if (iBeacons)
+      {
+        snprintf(line, sizeof(line), "OK+DISC:4C000215:%s:%04X%04X%02X:%s:-%03d",
+          d.uuid, d.major, d.minor, uint8_t(d.measuredPower), d.mac, -d.rssi);
+      }
+      else
+      {
+        int n = snprintf(line, sizeof(line), "OK+DIS%u:%s", unsigned(i % 10), d.mac);
+        if (show & 2) n += snprintf(line + n, sizeof(line) - n, "OK+RSSI:-%03d", -d.rssi);
+        if ((show & 1) && d.name) snprintf(line + n, sizeof(line) - n, "OK+NAME:%s\r\n", d.name);
+      }
+      queue(events[i].first, line);
+    }
+    queue(t + uint32_t(timing_.scanTime) * 1000UL, "OK+DISCE");
+  }
+
+  void connect(uint64_t t, const std::string &mac)
+  {
+    if (!master_ || !immediate_) {queue(t, "OK+CONNE"); return;}
+    queue(t, "OK+CONNA");
+    linkPending_ = true;
+    linkFound_ = false;
+    linkTime_ = t + uint32_t(timing_.connectFailTime) * 1000UL;
+    for (size_t i = 0; i < devices_.size(); i++)
+    {
+      if (devices_[i].connectable && mac == devices_[i].mac)
+      {
+        linkFound_ = true;
+        peer_ = mac;
+        linkTime_ = t + uint32_t(timing_.connectTime) * 1000UL;
+        return;
+      }
+    }
+  }
+
+  static uint8_t hexValue(char c) {return (c >= 'A') ? uint8_t(c - 'A' + 10) & 0x0F : uint8_t(c - '0') & 0x0F;}
+
+protected:
+  /* Protected member functions (transport, can be tapped by HM11_Trace) */
+  void BLESerial_begin(int32_t baudrate) {hostBaudrate_ = uint32_t(baudrate); advance();}
+  void BLESerial_end() {hostBaudrate_ = 0;}
+  bool BLESerial_ready() {return true;}
+  uint16_t BLESerial_available()
+  {
+    advance();
+    uint16_t n = 0;
+    for (size_t i = 0; i < output_.size() && reached(output_[i].time); i++) n++;
+    return n;
+  }
+  void BLESerial_print(String str)
+  {
+    for (uint16_t i = 0; i < str.length(); i++) BLESerial_write(str[i]);
+  }
+  void BLESerial_write(uint8_t b)
+  {
+    advance();
+    clock_ += 10000000UL / (hostBaudrate_ ? hostBaudrate_ : moduleBaudrate_);   // blocking UART
+    if (hostBaudrate_ != moduleBaudrate_) return;   // not understood by the module
+    command_ += char(b);
+    lastRxTime_ = clock_;
+  }
+  int16_t BLESerial_read()
+  {
+    if (!BLESerial_available()) return -1;
+    uint8_t b = output_.front().data;
+    output_.pop_front();
+    return (hostBaudrate_ == moduleBaudrate_) ? b : 0xFF;   // garbage at the wrong baudrate
+  }
+  void BLESerial_flush() {}
+  bool BLESerial_wait(uint16_t timeout)
+  {
+    uint64_t until = clock_ + uint32_t(timeout) * 1000UL;
+    while (!BLESerial_available() && !reached(until))
+    {
+      uint64_t t = nextEventTime(until);
+      if (t > clock_) clock_ = t;
+      else clock_ += TICK;
+    }
+    return BLESerial_available() > 0;
+  }
+  uint32_t BLE_millis()
+  {
+    clock_ += TICK;
+    advance();
+    return uint32_t(clock_ / 1000);   // wraps after ~49.7 days like millis()
+  }
+  void BLE_delay(uint32_t ms)
+  {
+    advance();
+    clock_ += uint64_t(ms) * 1000;
+    advance();
+  }
+};
+
+#endif
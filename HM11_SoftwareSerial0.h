@@ -70,12 +70,14 @@ private:
   /* Private member data */
   SoftwareSerial0& BLESerial_;
 
-  /* Private member functions */
+protected:
+  /* Protected member functions (transport, can be tapped by HM11_Trace) */
   void BLESerial_begin(int32_t baudrate) {BLESerial_.begin(baudrate);}
   void BLESerial_end() {BLESerial_.end();}
   bool BLESerial_ready() {return BLESerial_;}
   uint16_t BLESerial_available() {return BLESerial_.available();}
   void BLESerial_print(String str) {BLESerial_.print(str);}
+  void BLESerial_write(uint8_t b) {BLESerial_.write(b);}
   int16_t BLESerial_read() {return BLESerial_.read();}
   void BLESerial_flush() {BLESerial_.flush();}
 };
@@ -0,0 +1,166 @@
+#ifndef _LIB_HM11_Trace_H_
+#define _LIB_HM11_Trace_H_
+/*******************************************************************************
+* \file    HM11_Trace.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   UART trace capture for any HM11 backend
+*
+* \section DESCRIPTION
+* HM11_Trace<Backend> taps the BLESerial layer of a backend and hands every
+* received and transmitted byte with its timestamp to a writer callback
+* (e.g. writing to an SD card, a second UART or a file on the host). The
+* trace can be fed into HM11_Replay to reproduce the exact byte timing.
+* Received bytes are stamped with the time BLESerial_available() reported
+* them first, not when the library read them, so the trace shows the timing
+* of the module rather than the one of the parser.
+*
+* Trace format (little effort to parse, ~2 bytes per UART byte):
+*   header  'H' 'M' 'T' HM11_TRACE_VERSION
+*   event   varint((dt << 1) | tx) data
+* dt is the time since the previous event (or since setTraceWriter()) in us,
+* the varint is LEB128 (7 bits per byte, least significant group first).
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include "HM11.h"
+
+/* ==================== Global module constant declaration ================== */
+#define HM11_TRACE_VERSION      1
+#define HM11_TRACE_HEADER_SIZE  4
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+template <class Backend>
+class HM11_Trace : public Backend
+{
+public:
+  /* Public member typedefs */
+  typedef void (*traceWriter_t)(const uint8_t *data, uint8_t length, void *context);
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  using Backend::Backend;
+  // Example instantation:
+  // HM11_Trace<HM11_HardwareSerial> BLE(Serial1, &PORTD, 2, &PORTD, 3, &PORTD, 7, &PORTB, 0);
+  // BLE.setTraceWriter(writeToCard, NULL);
+
+  /* Public member functions */
+  void setTraceWriter(traceWriter_t writer, void *context = NULL)  // NULL stops the capture
+  {
+    static const uint8_t header[HM11_TRACE_HEADER_SIZE] = {'H', 'M', 'T', HM11_TRACE_VERSION};
+    writer_ = writer;
+    context_ = context;
+    lastMicros_ = micros();
+    if (writer_ != NULL) writer_(header, sizeof(header), context_);
+  }
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t MAX_ARRIVALS = 4;  // more bursts get merged into the last one
+
+  /* Private member data */
+  traceWriter_t writer_ = NULL;
+  void *context_ = NULL;
+  uint32_t lastMicros_ = 0;
+  uint16_t unread_ = 0;                     // bytes reported by BLESerial_available() but not read yet
+  uint8_t arrivalCount_ = 0;
+  uint8_t arrivalBytes_[MAX_ARRIVALS];      // bytes per burst
+  uint32_t arrivalMicros_[MAX_ARRIVALS];    // arrival time per burst
+
+  /* Private member functions */
+  void trace(uint8_t b, bool tx, uint32_t us)
+  {
+    if (writer_ == NULL) return;
+    uint32_t dt = us - lastMicros_;
+    if (dt > 0x7FFFFFFFUL) dt = 0;   // stamped before the previous event -> keep the order
+    else lastMicros_ = us;
+
+    uint8_t event[6];
+    uint8_t length = 0;
+    uint32_t value = (dt << 1) | tx;
+    while (value >= 0x80)
+    {
+      event[length++] = uint8_t(value) | 0x80;
+      value >>= 7;
+    }
+    event[length++] = uint8_t(value);
+    event[length++] = b;
+    writer_(event, length, context_);
+  }
+
+  void BLESerial_print(String str)
+  {
+    uint32_t us = micros();
+    for (uint16_t i = 0; i < str.length(); i++) trace(str[i], true, us);
+    Backend::BLESerial_print(str);
+  }
+  void BLESerial_write(uint8_t b)
+  {
+    trace(b, true, micros());
+    Backend::BLESerial_write(b);
+  }
+  uint16_t BLESerial_available()
+  {
+    uint16_t n = Backend::BLESerial_available();
+    if (n > unread_ && writer_ != NULL)
+    {
+      uint8_t bytes = (n - unread_ > UINT8_MAX) ? UINT8_MAX : n - unread_;
+      if (arrivalCount_ < MAX_ARRIVALS)
+      {
+        arrivalBytes_[arrivalCount_] = bytes;
+        arrivalMicros_[arrivalCount_++] = micros();
+      }
+      else if (arrivalBytes_[MAX_ARRIVALS - 1] <= UINT8_MAX - bytes) arrivalBytes_[MAX_ARRIVALS - 1] += bytes;
+      unread_ = n;
+    }
+    return n;
+  }
+  int16_t BLESerial_read()
+  {
+    int16_t b = Backend::BLESerial_read();
+    if (b < 0) return b;
+    if (unread_ > 0) unread_--;
+
+    uint32_t us = micros();
+    if (arrivalCount_ > 0)
+    {
+      /* oldest burst first */
+      us = arrivalMicros_[0];
+      if (--arrivalBytes_[0] == 0)
+      {
+        arrivalCount_--;
+        for (uint8_t i = 0; i < arrivalCount_; i++)
+        {
+          arrivalBytes_[i] = arrivalBytes_[i + 1];
+          arrivalMicros_[i] = arrivalMicros_[i + 1];
+        }
+      }
+    }
+    trace(b, false, us);
+    return b;
+  }
+};
+
+#endif
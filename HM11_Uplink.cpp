@@ -0,0 +1,280 @@
+/*******************************************************************************
+* \file    HM11_Uplink.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Uplink.h"
+
+/* ======================= Module constant declaration ====================== */
+
+/* ======================== Module macro declaration ======================== */
+
+/* ====================== Module class instantiations ======================= */
+
+/* ======================== Public member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     encode
+  * \brief  packs a scan record (see the format in the header file)
+  *
+  * \param  record     scan record (e.g. of pollIBeaconScan)
+  * \param  timestamp  time of the record in ms
+  * \param  out        output buffer of at least MAX_RECORD_SIZE bytes
+  * \return record length in bytes
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Uplink::encode(const HM11::iBeaconRecord_t *record, uint32_t timestamp, uint8_t *out)
+  {
+    uint8_t length = 2;
+    bool fullUUID = true;
+    int8_t slot = findUUID(record->uuid);
+    if (slot < 0) slot = int8_t(addUUID(record->uuid));   // NO_SLOT without a dictionary
+    else if (slotCountdown_[slot] > 0)
+    {
+      slotCountdown_[slot]--;
+      fullUUID = false;
+    }
+    else slotCountdown_[slot] = REFRESH_INTERVAL;
+
+    out[0] = SYNC;
+    out[1] = uint8_t(slot);
+    if (fullUUID)
+    {
+      out[1] |= UUID_FOLLOWS;
+      memcpy(&out[length], record->uuid, 16);
+      length += 16;
+    }
+
+    if (record->accessAddress != IBEACON_ACCESS)
+    {
+      out[1] |= ACCESS_ADDRESS;
+      for (int8_t shift = 24; shift >= 0; shift -= 8) out[length++] = uint8_t(record->accessAddress >> shift);
+    }
+    memcpy(&out[length], record->mac, 6);
+    length += 6;
+    out[length++] = uint8_t(record->major >> 8);
+    out[length++] = uint8_t(record->major);
+    out[length++] = uint8_t(record->minor >> 8);
+    out[length++] = uint8_t(record->minor);
+    out[length++] = uint8_t(record->measuredPower);
+    out[length++] = uint8_t(record->rssi);
+
+    if (timeCountdown_ == 0)
+    {
+      out[1] |= ABSOLUTE_TIME;
+      for (int8_t shift = 24; shift >= 0; shift -= 8) out[length++] = uint8_t(timestamp >> shift);
+      timeCountdown_ = REFRESH_INTERVAL;
+    }
+    else
+    {
+      timeCountdown_--;
+      uint32_t dt = timestamp - lastTimestamp_;
+      while (dt >= 0x80)
+      {
+        out[length++] = uint8_t(dt) | 0x80;
+        dt >>= 7;
+      }
+      out[length++] = uint8_t(dt);
+    }
+    lastTimestamp_ = timestamp;
+
+    uint8_t crc = 0;
+    for (uint8_t i = 1; i < length; i++) crc = HM11_Codec::crc8(crc, out[i]);
+    out[length++] = crc;
+    return length;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     decode
+  * \brief  unpacks a record (the dictionary and the time base are only
+  *         updated if the record is complete and its CRC matched)
+  *
+  * \param  in         received bytes
+  * \param  length     number of received bytes
+  * \param  record     unpacked scan record
+  * \param  timestamp  time of the record in ms
+  * \return consumed bytes, 0 if the record is incomplete, -n if the first n
+  *         bytes have to be dropped (no sync byte, CRC mismatch, unknown
+  *         slot or delta time without a base) -> call again with the rest
+  --------------------------------------------------------------------------- */
+  int8_t HM11_Uplink::decode(const uint8_t *in, uint8_t length, HM11::iBeaconRecord_t *record, uint32_t *timestamp)
+  {
+    if (length == 0) return 0;
+    if (in[0] != SYNC)
+    {
+      uint8_t skip = 1;
+      while (skip < length && skip < INT8_MAX && in[skip] != SYNC) skip++;
+      lost();
+      return -int8_t(skip);
+    }
+    if (length < 2) return 0;
+    uint8_t header = in[1];
+    bool uuidFollows = (header & UUID_FOLLOWS);
+    uint8_t slot = header & SLOT;
+    if ((header & RESERVED) || (slot != NO_SLOT && slot >= HM11_UPLINK_DICTIONARY_SIZE) ||
+      (!uuidFollows && slot == NO_SLOT))
+    {
+      lost();
+      return -1;
+    }
+
+    uint8_t pos = 2;
+    uint8_t fixed = (uuidFollows ? 16 : 0) + ((header & ACCESS_ADDRESS) ? 4 : 0) + 6 + 2 + 2 + 1 + 1;
+    if (length < pos + fixed + 1) return 0;
+
+    /* time: 4 bytes absolute or a varint of max. 5 bytes, then the CRC */
+    uint8_t end = pos + fixed;
+    if (header & ABSOLUTE_TIME) end += 4;
+    else
+    {
+      while (end < length && (in[end] & 0x80) && end < pos + fixed + 4) end++;
+      if (end >= length) return 0;
+      if (in[end] & 0x80)
+      {
+        lost();
+        return -1;
+      }
+      end++;
+    }
+    if (end >= length) return 0;
+    uint8_t crc = 0;
+    for (uint8_t i = 1; i < end; i++) crc = HM11_Codec::crc8(crc, in[i]);
+    if (crc != in[end])   // the sync byte was data or the record is corrupt
+    {
+      lost();
+      return -1;
+    }
+
+    /* valid record, the time base follows every record */
+    uint8_t timePos = end - ((header & ABSOLUTE_TIME) ? 4 : 0);
+    if (header & ABSOLUTE_TIME)
+    {
+      lastTimestamp_ = (uint32_t(in[timePos]) << 24) | (uint32_t(in[timePos + 1]) << 16) |
+        (uint16_t(in[timePos + 2]) << 8) | in[timePos + 3];
+      timeValid_ = true;
+    }
+    else
+    {
+      timePos = pos + fixed;
+      uint32_t dt = 0;
+      for (uint8_t shift = 0; timePos < end; shift += 7) dt |= uint32_t(in[timePos++] & 0x7F) << shift;
+      lastTimestamp_ += dt;
+    }
+
+    /* unresolvable records are dropped as a whole */
+    int8_t consumed = int8_t(end + 1);
+    if (!uuidFollows && !(dictionaryValid_ & (1 << slot))) return -consumed;
+    if (!timeValid_) return -consumed;
+
+    if (uuidFollows)
+    {
+      memcpy(record->uuid, &in[pos], 16);
+      pos += 16;
+      if (slot != NO_SLOT)
+      {
+        memcpy(dictionary_[slot], record->uuid, 16);
+        dictionaryValid_ |= 1 << slot;
+      }
+    }
+    else memcpy(record->uuid, dictionary_[slot], 16);
+    record->accessAddress = IBEACON_ACCESS;
+    if (header & ACCESS_ADDRESS)
+    {
+      record->accessAddress = (uint32_t(in[pos]) << 24) | (uint32_t(in[pos + 1]) << 16) | (uint16_t(in[pos + 2]) << 8) | in[pos + 3];
+      pos += 4;
+    }
+    memcpy(record->mac, &in[pos], 6);
+    pos += 6;
+    record->major = (uint16_t(in[pos]) << 8) | in[pos + 1];
+    record->minor = (uint16_t(in[pos + 2]) << 8) | in[pos + 3];
+    record->measuredPower = int8_t(in[pos + 4]);
+    record->rssi = int8_t(in[pos + 5]);
+
+    *timestamp = lastTimestamp_;
+    return consumed;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     refresh
+  * \brief  sends the UUIDs in full and the absolute time with the next
+  *         records again (e.g. after write() refused a record)
+  --------------------------------------------------------------------------- */
+  void HM11_Uplink::refresh()
+  {
+    memset(slotCountdown_, 0, sizeof(slotCountdown_));
+    timeCountdown_ = 0;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     reset
+  * \brief  forgets the dictionary and the time base (e.g. after a reconnect)
+  --------------------------------------------------------------------------- */
+  void HM11_Uplink::reset()
+  {
+    dictionaryValid_ = 0;
+    dictionaryNext_ = 0;
+    timeValid_ = false;
+    lastTimestamp_ = 0;
+    refresh();
+  }
+
+/* ======================= Private member Functions ========================= */
+/** -------------------------------------------------------------------------
+  * \fn     lost
+  * \brief  forgets the dictionary and the time base of the decoder after a
+  *         record got lost, they could have been updated by it
+  --------------------------------------------------------------------------- */
+  void HM11_Uplink::lost()
+  {
+    dictionaryValid_ = 0;
+    timeValid_ = false;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     findUUID
+  * \brief  looks up a UUID in the dictionary
+  *
+  * \param  uuid   16 bytes
+  * \return slot or -1 if it is unknown
+  --------------------------------------------------------------------------- */
+  int8_t HM11_Uplink::findUUID(const uint8_t *uuid)
+  {
+    for (uint8_t i = 0; i < HM11_UPLINK_DICTIONARY_SIZE; i++)
+    {
+      if ((dictionaryValid_ & (1 << i)) && memcmp(dictionary_[i], uuid, 16) == 0) return int8_t(i);
+    }
+    return -1;
+  }
+
+/** -------------------------------------------------------------------------
+  * \fn     addUUID
+  * \brief  adds a UUID to the dictionary, the oldest entry gets replaced
+  *
+  * \param  uuid   16 bytes
+  * \return slot or NO_SLOT if there is no dictionary
+  --------------------------------------------------------------------------- */
+  uint8_t HM11_Uplink::addUUID(const uint8_t *uuid)
+  {
+    if (HM11_UPLINK_DICTIONARY_SIZE == 0) return NO_SLOT;
+    uint8_t slot = dictionaryNext_;
+    memcpy(dictionary_[slot], uuid, 16);
+    dictionaryValid_ |= 1 << slot;
+    slotCountdown_[slot] = REFRESH_INTERVAL;
+    dictionaryNext_ = (dictionaryNext_ + 1) % (HM11_UPLINK_DICTIONARY_SIZE ? HM11_UPLINK_DICTIONARY_SIZE : 1);
+    return slot;
+  }
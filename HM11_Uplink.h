@@ -0,0 +1,126 @@
+#ifndef _LIB_HM11_Uplink_H_
+#define _LIB_HM11_Uplink_H_
+/*******************************************************************************
+* \file    HM11_Uplink.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Compact binary format of scan records for the uplink to a gateway
+*
+* \section DESCRIPTION
+* encode() packs an HM11::iBeaconRecord_t with its timestamp into 16..40
+* bytes instead of the 78 hex characters of the "OK+DISC:" line:
+*   sync     1 byte   SYNC
+*   header   1 byte   bits 0..3: UUID dictionary slot (15 -> none)
+*                     bit 4: access address follows (not 0x4C000215)
+*                     bit 5: absolute time follows instead of the delta
+*                     bit 6: UUID follows (and is stored in the slot)
+*                     bit 7: 0
+*   [uuid]   16 bytes
+*   [access] 4 bytes
+*   mac      6 bytes
+*   major    2 bytes (big endian)
+*   minor    2 bytes (big endian)
+*   measuredPower, rssi   1 byte each
+*   time     varint, ms since the previous record (7 bits per byte)
+*            or 4 bytes (big endian) absolute ms
+*   crc      1 byte   CRC-8 of header..time (see HM11_Codec::crc8)
+* A UUID which is sent in full is stored in the dictionary of both sides at
+* the slot given in the header, the following records of the same UUID only
+* send the slot -> a typical record has 17 bytes (~4.5x smaller). Every
+* REFRESH_INTERVAL records of a UUID it is sent in full again and every
+* REFRESH_INTERVAL records (and first after reset()) the time is absolute,
+* so a gateway which lost a record, joined late or missed a reset() heals
+* within REFRESH_INTERVAL records per UUID. decode() hunts for the sync byte
+* and drops corrupt records and records it cannot resolve yet (unknown
+* slot, delta time without a base). A lost record could have changed a slot
+* or the time base, so the decoder forgets both and relearns them.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include "HM11.h"
+#include "HM11_Codec.h"
+
+/* ==================== Global module constant declaration ================== */
+/* UUIDs known by index (16 bytes of RAM each, max. 15, 0 -> no dictionary) */
+#ifndef HM11_UPLINK_DICTIONARY_SIZE
+  #define HM11_UPLINK_DICTIONARY_SIZE  4
+#endif
+
+/* ========================= Global macro declaration ======================= */
+
+/* ============================ Class declaration =========================== */
+static_assert(HM11_UPLINK_DICTIONARY_SIZE < 16, "HM11_UPLINK_DICTIONARY_SIZE has to be less than 16!");
+
+class HM11_Uplink
+{
+public:
+  /* Public member typedefs */
+  //...
+
+  /* Public member data */
+  //...
+
+  /* Constructor(s) and  Destructor*/
+  HM11_Uplink() {reset();};
+  ~HM11_Uplink() {};
+  // Example instantation:
+  // HM11_Uplink uplink;
+  // uint8_t length = uplink.encode(&record, BLE.getMillis(), buffer);   // node, for every SCAN_RECORD
+  // if (BLE.write(buffer, length) != length) uplink.refresh();         // TX queue full -> record lost
+  // int8_t n = uplink.decode(data, length, &record, &timestamp);       // gateway, n < 0 -> drop -n bytes
+
+  /* Public constants */
+  static const uint8_t MAX_RECORD_SIZE = 1 + 1 + 16 + 4 + 6 + 2 + 2 + 1 + 1 + 5 + 1;
+  static const uint8_t SYNC            = 0xA5;
+  static const uint8_t REFRESH_INTERVAL = 16;   // in records
+
+  /* Public member functions */
+  uint8_t encode(const HM11::iBeaconRecord_t *record, uint32_t timestamp, uint8_t *out);  // returns the length
+  int8_t decode(const uint8_t *in, uint8_t length, HM11::iBeaconRecord_t *record, uint32_t *timestamp);  // returns the consumed bytes, 0 -> incomplete, < 0 -> drop -n bytes
+  void refresh();   // next records with full UUID and absolute time (e.g. after a lost one)
+  void reset();
+
+private:
+  /* Private constant declerations (static) */
+  static const uint8_t SLOT             = 0x0F;
+  static const uint8_t NO_SLOT          = 0x0F;
+  static const uint8_t ACCESS_ADDRESS   = 0x10;
+  static const uint8_t ABSOLUTE_TIME    = 0x20;
+  static const uint8_t UUID_FOLLOWS     = 0x40;
+  static const uint8_t RESERVED         = 0x80;
+  static const uint32_t IBEACON_ACCESS  = 0x4C000215;  // Apple, iBeacon, 21 bytes
+
+  /* Private member data */
+  uint8_t dictionary_[HM11_UPLINK_DICTIONARY_SIZE ? HM11_UPLINK_DICTIONARY_SIZE : 1][16];
+  uint8_t slotCountdown_[HM11_UPLINK_DICTIONARY_SIZE ? HM11_UPLINK_DICTIONARY_SIZE : 1];  // records until the UUID is sent in full again (encoder)
+  uint16_t dictionaryValid_;  // bit per slot
+  uint8_t dictionaryNext_;    // round robin (encoder)
+  uint8_t timeCountdown_;     // records until the next absolute time (encoder)
+  bool timeValid_;            // absolute time received (decoder)
+  uint32_t lastTimestamp_;
+
+  /* Private member functions */
+  int8_t findUUID(const uint8_t *uuid);
+  uint8_t addUUID(const uint8_t *uuid);
+  void lost();
+};
+
+#endif
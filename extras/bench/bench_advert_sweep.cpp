@@ -0,0 +1,63 @@
+/*******************************************************************************
+* \file    bench_advert_sweep.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Sweep driver of HM11_AdvertModel
+*
+* \section DESCRIPTION
+* Sweeps every advertising interval, TX power and the scan times below, once
+* for a beacon configured by setIBeaconMode() (PWRM1, the default
+* environment) and once for a PWRM0 beacon (autoSleep), and prints the
+* Pareto-optimal combinations with a detection probability of at least
+* MIN_PROBABILITY and the run time of the sweep. The numbers are modelled,
+* see HM11_AdvertModel.h for the assumptions.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_AdvertModel.h"
+
+/* ======================= Module constant declaration ====================== */
+static const uint16_t SCAN_TIMES[] = {500, 1000, 2000, 3000, 5000};
+static const double MIN_PROBABILITY = 0.9;
+
+/* ======================== Module function definitions ===================== */
+static void sweep(const char *title, const HM11_AdvertModel::environment_t *environment)
+{
+  HM11_AdvertModel model(environment);
+  uint64_t us = hostMicros();
+  const std::vector<HM11_AdvertModel::result_t> &results = model.sweep(SCAN_TIMES, sizeof(SCAN_TIMES) / sizeof(SCAN_TIMES[0]));
+  us = hostMicros() - us;
+
+  printf("%s: %u combinations x %u trials in %.2f s\n", title, unsigned(results.size()),
+    unsigned(environment->trials), us / 1e6);
+  model.printParetoTable(stdout, MIN_PROBABILITY);
+  printf("\n");
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_AdvertModel::environment_t environment = HM11_AdvertModel::defaultEnvironment();
+  sweep("PWRM1 (setIBeaconMode)", &environment);
+  environment.autoSleep = true;
+  sweep("PWRM0 (auto sleep)", &environment);
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+* \file    bench_codec.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Compression ratio and cost per byte of HM11_Codec
+*
+* \section DESCRIPTION
+* Encodes and decodes FRAMES frames of 4 channels for a few typical signals
+* (constant, slow ramp, sine with noise, full scale noise as the worst case)
+* with the default keyframe interval and reports the compression ratio and
+* the ns and TSC cycles (x86 only) per raw byte of the encoder and per coded
+* byte of the decoder. These are host cycles, on an ATmega the varint loop
+* costs roughly one order of magnitude more.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include <math.h>
+#include <vector>
+#include "HM11_Codec.h"
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+/* ======================= Module constant declaration ====================== */
+static const uint32_t FRAMES = 200000;
+static const uint8_t CHANNELS = 4;
+
+typedef enum : uint8_t
+{
+  SIGNAL_CONSTANT = 0,
+  SIGNAL_RAMP     = 1,
+  SIGNAL_SINE     = 2,
+  SIGNAL_NOISE    = 3
+} signal_t;
+
+/* ======================== Module function definitions ===================== */
+static uint64_t cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int16_t sample(signal_t signal, uint32_t frame, uint8_t channel)
+{
+  switch (signal)
+  {
+    case SIGNAL_CONSTANT: return int16_t(1000 * channel);
+    case SIGNAL_RAMP:     return int16_t(frame / 8 + channel);
+    case SIGNAL_SINE:     return int16_t(2000 * sin(frame * 0.01 + channel) + random(-3, 4));
+    default:              return int16_t(random(-32768, 32768));
+  }
+}
+
+static void bench(signal_t signal, const char *name)
+{
+  std::vector<int16_t> values(FRAMES * CHANNELS);
+  for (uint32_t f = 0; f < FRAMES; f++)
+  {
+    for (uint8_t c = 0; c < CHANNELS; c++) values[f * CHANNELS + c] = sample(signal, f, c);
+  }
+  std::vector<uint8_t> link;
+  link.reserve(FRAMES * HM11_Codec::MAX_FRAME_SIZE);
+
+  HM11_Codec encoder(CHANNELS);
+  uint8_t frame[HM11_Codec::MAX_FRAME_SIZE];
+  uint64_t us = hostMicros();
+  uint64_t c = cycles();
+  for (uint32_t f = 0; f < FRAMES; f++)
+  {
+    uint8_t length = encoder.encode(&values[f * CHANNELS], frame);
+    link.insert(link.end(), frame, frame + length);
+  }
+  double encodeCycles = double(cycles() - c);
+  double encodeNs = (hostMicros() - us) * 1000.0;
+
+  HM11_Codec decoder(CHANNELS);
+  uint32_t frames = 0;
+  bool exact = true;
+  us = hostMicros();
+  c = cycles();
+  for (size_t i = 0; i < link.size(); i++)
+  {
+    if (decoder.decode(link[i]))
+    {
+      exact = exact && (memcmp(decoder.getValues(), &values[frames * CHANNELS], CHANNELS * sizeof(int16_t)) == 0);
+      frames++;
+    }
+  }
+  double decodeCycles = double(cycles() - c);
+  double decodeNs = (hostMicros() - us) * 1000.0;
+
+  const HM11_Codec::codecStats_t *stats = encoder.getEncoderStats();
+  printf("%-8s  %6.2f:1  %8.2f  %9.1f  %8.2f  %9.1f  %s\n", name,
+    HM11_Codec::getRatio(stats) / 100.0,
+    encodeNs / stats->rawBytes, encodeCycles / stats->rawBytes,
+    decodeNs / link.size(), decodeCycles / link.size(),
+    (exact && frames == FRAMES) ? "ok" : "MISMATCH");
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  printf("signal       ratio  enc ns/B  enc cyc/B  dec ns/B  dec cyc/B  round trip\n");
+  bench(SIGNAL_CONSTANT, "constant");
+  bench(SIGNAL_RAMP, "ramp");
+  bench(SIGNAL_SINE, "sine");
+  bench(SIGNAL_NOISE, "noise");
+  return 0;
+}
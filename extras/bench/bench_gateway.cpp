@@ -0,0 +1,91 @@
+/*******************************************************************************
+* \file    bench_gateway.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Throughput and latency of HM11_Gateway against fake modules
+*
+* \section DESCRIPTION
+* 1 to 48 PtyModules (one I/O thread each) answer the scans with
+* SCAN_RECORDS records each (the same 50 iBeacons on every module ->
+* duplicates). Every configuration waits until all modules have been set
+* up (~2 s, reported), then measures for MEASURE_TIME and reports the
+* aggregated records/s after the setup, the mean and max latency (record
+* parsed -> aggregated) and the queue / dedup counters.
+* The pty round trip dominates, so the numbers are an upper bound for the
+* parsing and aggregation only and not for real 9600 baud modules.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Gateway.h"
+#include "PtyModule.h"
+
+/* ======================= Module constant declaration ====================== */
+static const uint16_t SCAN_RECORDS = 500;    // per scan and module
+static const uint16_t RECORD_SPACING = 100;  // in us
+static const uint16_t MEASURE_TIME = 4000;   // in ms per configuration, after the setup
+static const uint16_t SETUP_TIMEOUT = 30000; // in ms
+static const uint8_t MODULES[] = {1, 2, 4, 8, 16, 32, 48};
+
+/* ======================== Module function definitions ===================== */
+static void onRecord(const HM11_Gateway::gatewayRecord_t *record, void *context)
+{
+  (void)record;
+  (void)context;
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  printf("%u cores\n", std::thread::hardware_concurrency());
+  printf("modules  setup [ms]  records/s  latency mean [us]  max [us]  forwarded  duplicates  dropped  setup failures\n");
+  for (uint8_t c = 0; c < sizeof(MODULES); c++)
+  {
+    uint8_t n = MODULES[c];
+    std::vector<PtyModule *> modules;
+    HM11_Gateway gateway(onRecord, NULL, 1000, 1000);
+    for (uint8_t i = 0; i < n; i++)
+    {
+      modules.push_back(new PtyModule());
+      modules[i]->setScanRecords(SCAN_RECORDS, RECORD_SPACING);
+      gateway.addPort(modules[i]->getDevice());
+    }
+
+    /* the records/s are measured from the end of the setup of all modules */
+    gateway.start();
+    for (uint16_t t = 0; t < SETUP_TIMEOUT && gateway.getSetupTime() == 0; t += 10)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(MEASURE_TIME));
+    uint32_t setupTime = gateway.getSetupTime();
+    uint32_t rate = gateway.getRecordsPerSecond();
+    uint32_t latency = gateway.getAverageLatency();
+    gateway.stop();
+
+    HM11_Gateway::gatewayStats_t stats = gateway.getStats();
+    printf("%7u  %10u  %9u  %17u  %8llu  %9llu  %10llu  %7llu  %14llu\n", n, setupTime, rate, latency,
+      (unsigned long long)(stats.latencyMax / 1000), (unsigned long long)stats.forwarded,
+      (unsigned long long)stats.duplicates, (unsigned long long)stats.dropped,
+      (unsigned long long)stats.setupFailures);
+    for (uint8_t i = 0; i < n; i++) delete modules[i];
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+* \file    bench_proximity.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Cost of HM11_Proximity::update() per scan record
+*
+* \section DESCRIPTION
+* Feeds UPDATES records of 1, HM11_PROXIMITY_MAX_BEACONS and
+* 2 * HM11_PROXIMITY_MAX_BEACONS beacons (-> replacement of the least
+* recently seen beacon) into both filters and reports the ns and the TSC
+* cycles (x86 only) per update. The driver clock comes from HM11_Simulator.
+* These are host cycles: an ATmega has no hardware divider and no 32 bit
+* multiplier, so they only compare the variants with each other.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Proximity.h"
+#include "HM11_Simulator.h"
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+/* ======================= Module constant declaration ====================== */
+static const uint32_t UPDATES = 1000000;
+
+/* ======================== Module function definitions ===================== */
+static uint64_t cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void bench(HM11_Simulator &ble, HM11_Proximity::filter_t filter, uint8_t beacons)
+{
+  HM11_Proximity proximity(ble, filter);
+  HM11::iBeaconRecord_t record;
+  memset(&record, 0, sizeof(record));
+  record.measuredPower = -59;
+
+  volatile uint16_t sink = 0;   // keeps the updates alive
+  uint64_t us = hostMicros();
+  uint64_t c = cycles();
+  for (uint32_t i = 0; i < UPDATES; i++)
+  {
+    record.mac[5] = uint8_t(i % beacons);
+    record.rssi = int8_t(-60 - int8_t(i % 17));
+    sink = proximity.update(&record)->distance;
+    if ((i & 1023) == 0) ble.run(1);   // advances the driver clock
+  }
+  c = cycles() - c;
+  us = hostMicros() - us;
+  (void)sink;
+  printf("%-7s %7u  %11.1f  %15.1f\n", (filter == HM11_Proximity::FILTER_EWMA) ? "EWMA" : "Kalman",
+    beacons, us * 1000.0 / UPDATES, double(c) / UPDATES);
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Simulator ble;
+  const uint8_t BEACONS[] = {1, HM11_PROXIMITY_MAX_BEACONS, 2 * HM11_PROXIMITY_MAX_BEACONS};
+  printf("filter  beacons  ns / update  cycles / update\n");
+  for (uint8_t f = 0; f < 2; f++)
+  {
+    for (uint8_t b = 0; b < sizeof(BEACONS); b++) bench(ble, HM11_Proximity::filter_t(f), BEACONS[b]);
+  }
+  return 0;
+}
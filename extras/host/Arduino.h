@@ -0,0 +1,223 @@
+#ifndef _LIB_HM11_HOST_Arduino_H_
+#define _LIB_HM11_HOST_Arduino_H_
+/*******************************************************************************
+* \file    Arduino.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Minimal Arduino compatible core to build the library on a host
+*
+* \section DESCRIPTION
+* Just what the library uses, so HM11.cpp and the other sources compile
+* with g++ on Linux together with the host backends (HM11_PosixSerial,
+* HM11_Simulator, HM11_Replay):
+* - String on top of std::string (only the members used by the library)
+* - PROGMEM and the pgm_read_* / *_P functions map to plain RAM accesses
+* - millis(), micros() and delay() on CLOCK_MONOTONIC
+* - Print / Stream / HardwareSerial, Serial writes to stdout
+* Add the directory of this file to the include path (-Iextras/host), see
+* extras/run_host.sh.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+
+/* ==================== Global module constant declaration ================== */
+#define DEC 10
+#define HEX 16
+
+/* ========================= Global macro declaration ======================= */
+#define PROGMEM
+#define PGM_P                 const char *
+#define PSTR(s)               (s)
+#define F(s)                  ((const __FlashStringHelper *)(s))
+#define FPSTR(s)              ((const __FlashStringHelper *)(s))
+#define pgm_read_byte(p)      (*(const uint8_t *)(p))
+#define pgm_read_word(p)      (*(const uint16_t *)(p))
+#define pgm_read_dword(p)     (*(const uint32_t *)(p))
+#define pgm_read_ptr(p)       (*(void * const *)(p))
+#define memcpy_P              memcpy
+#define strlen_P              strlen
+#define strchr_P              strchr
+#define strstr_P              strstr
+#define strcmp_P              strcmp
+#define strncmp_P             strncmp
+#define _BV(bit)              (1 << (bit))
+
+typedef uint8_t byte;
+class __FlashStringHelper;
+
+/* ========================== Global time functions ========================= */
+inline uint64_t hostMicros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000ULL + uint64_t(ts.tv_nsec) / 1000ULL;
+}
+inline unsigned long millis() {return (unsigned long)(uint32_t(hostMicros() / 1000ULL));}   // wraps like on the core
+inline unsigned long micros() {return (unsigned long)(uint32_t(hostMicros()));}
+inline void delayMicroseconds(unsigned int us)
+{
+  struct timespec ts = {time_t(us / 1000000U), long((us % 1000000U) * 1000L)};
+  while (nanosleep(&ts, &ts) != 0);
+}
+inline void delay(unsigned long ms)
+{
+  struct timespec ts = {time_t(ms / 1000UL), long((ms % 1000UL) * 1000000L)};
+  while (nanosleep(&ts, &ts) != 0);
+}
+inline long random(long howsmall, long howbig)
+{
+  return (howbig > howsmall) ? howsmall + rand() % (howbig - howsmall) : howsmall;
+}
+inline long random(long howbig) {return random(0, howbig);}
+
+/* ============================ Class declaration =========================== */
+class String
+{
+public:
+  String(const char *cstr = "") : s_(cstr ? cstr : "") {};
+  String(const __FlashStringHelper *str) : s_((const char *)str) {};
+  explicit String(char c) : s_(1, c) {};
+  String(int value, unsigned char base = DEC) : s_(format(long(value), base)) {};
+  String(unsigned int value, unsigned char base = DEC) : s_(format((unsigned long)value, base)) {};
+  String(long value, unsigned char base = DEC) : s_(format(value, base)) {};
+  String(unsigned long value, unsigned char base = DEC) : s_(format(value, base)) {};
+  String(unsigned char value, unsigned char base = DEC) : s_(format((unsigned long)value, base)) {};
+
+  unsigned int length() const {return (unsigned int)s_.size();}
+  bool reserve(unsigned int size) {s_.reserve(size); return true;}
+  const char *c_str() const {return s_.c_str();}
+  char operator[](unsigned int index) const {return (index < s_.size()) ? s_[index] : '\0';}
+  char charAt(unsigned int index) const {return (*this)[index];}
+
+  bool concat(const String &str) {s_ += str.s_; return true;}
+  bool concat(const char *cstr) {s_ += cstr; return true;}
+  bool concat(char c) {s_ += c; return true;}
+  String &operator+=(const String &str) {s_ += str.s_; return *this;}
+  String &operator+=(const char *cstr) {s_ += cstr; return *this;}
+  String &operator+=(char c) {s_ += c; return *this;}
+  friend String operator+(const String &a, const String &b) {String r(a); r.s_ += b.s_; return r;}
+  friend String operator+(const String &a, const char *b) {String r(a); r.s_ += b; return r;}
+  friend String operator+(const char *a, const String &b) {String r(a); r.s_ += b.s_; return r;}
+  friend String operator+(const String &a, char b) {String r(a); r.s_ += b; return r;}
+
+  bool equals(const String &str) const {return s_ == str.s_;}
+  bool operator==(const String &str) const {return s_ == str.s_;}
+  bool operator==(const char *cstr) const {return s_ == cstr;}
+  bool operator!=(const String &str) const {return s_ != str.s_;}
+  bool operator!=(const char *cstr) const {return s_ != cstr;}
+  bool startsWith(const String &prefix) const {return s_.compare(0, prefix.s_.size(), prefix.s_) == 0;}
+  bool endsWith(const String &suffix) const
+  {
+    return s_.size() >= suffix.s_.size() && s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const {return position(s_.find(c, from));}
+  int indexOf(const String &str, unsigned int from = 0) const {return position(s_.find(str.s_, from));}
+  int lastIndexOf(char c) const {return position(s_.rfind(c));}
+  int lastIndexOf(const String &str) const {return position(s_.rfind(str.s_));}
+  String substring(unsigned int from) const {return (from < s_.size()) ? String(s_.substr(from).c_str()) : String();}
+  String substring(unsigned int from, unsigned int to) const
+  {
+    if (to > s_.size()) to = (unsigned int)s_.size();
+    return (from < to) ? String(s_.substr(from, to - from).c_str()) : String();
+  }
+  void trim()
+  {
+    size_t first = s_.find_first_not_of(" \t\r\n\f\v");
+    if (first == std::string::npos) {s_.clear(); return;}
+    s_ = s_.substr(first, s_.find_last_not_of(" \t\r\n\f\v") - first + 1);
+  }
+  long toInt() const {return atol(s_.c_str());}
+
+private:
+  std::string s_;
+
+  static int position(size_t pos) {return (pos == std::string::npos) ? -1 : int(pos);}
+  static std::string format(unsigned long value, unsigned char base)
+  {
+    char buffer[8 * sizeof(long) + 1];
+    snprintf(buffer, sizeof(buffer), (base == HEX) ? "%lX" : "%lu", value);
+    return buffer;
+  }
+  static std::string format(long value, unsigned char base)
+  {
+    if (base == HEX) return format((unsigned long)value, base);
+    char buffer[8 * sizeof(long) + 2];
+    snprintf(buffer, sizeof(buffer), "%ld", value);
+    return buffer;
+  }
+};
+
+class Print
+{
+public:
+  virtual ~Print() {};
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size)
+  {
+    for (size_t i = 0; i < size; i++) write(buffer[i]);
+    return size;
+  }
+  size_t print(const String &str) {return write((const uint8_t *)str.c_str(), str.length());}
+  size_t print(const char *cstr) {return write((const uint8_t *)cstr, strlen(cstr));}
+  size_t print(const __FlashStringHelper *str) {return print((const char *)str);}
+  size_t print(char c) {return write(uint8_t(c));}
+  size_t print(long value, int base = DEC) {return print(String(value, uint8_t(base)));}
+  size_t print(unsigned long value, int base = DEC) {return print(String(value, uint8_t(base)));}
+  size_t print(int value, int base = DEC) {return print(long(value), base);}
+  size_t print(unsigned int value, int base = DEC) {return print((unsigned long)value, base);}
+  size_t println() {return print("\r\n");}
+  template <class T> size_t println(const T &value) {return print(value) + println();}
+  template <class T> size_t println(const T &value, int base) {return print(value, base) + println();}
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {};
+};
+
+class HardwareSerial : public Stream   // stdout, nothing is received
+{
+public:
+  void begin(unsigned long baudrate) {(void)baudrate;}
+  void end() {}
+  int available() {return 0;}
+  int read() {return -1;}
+  int peek() {return -1;}
+  void flush() {fflush(stdout);}
+  size_t write(uint8_t b) {return (fputc(b, stdout) == EOF) ? 0 : 1;}
+  using Print::write;
+  operator bool() {return true;}
+};
+
+static HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef _LIB_HM11_HOST_PtyModule_H_
+#define _LIB_HM11_HOST_PtyModule_H_
+/*******************************************************************************
+* \file    PtyModule.h
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Scripted fake HM11 module behind a pseudo-terminal (host only)
+*
+* \section DESCRIPTION
+* Opens a pty and answers on its master side like a module does, so
+* HM11_PosixSerial (and everything built on it) can be tested without
+* hardware: open getDevice() instead of /dev/ttyUSB0.
+* A command is processed after COMMAND_GAP of silence. Known are AT, ADDR?,
+* VERS?, RENEW, RESET, DISI? (iBeacon scan with the records of
+* setScanRecords()) and any other "AT+XXXX[value|?]" as a stored setting
+* ("OK+Set:" / "OK+Get:"). unplug() closes the master side, the backend then
+* gets EIO like after unplugging a USB-UART adapter.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ============================== Global imports ============================ */
+#include <fcntl.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* ============================ Class declaration =========================== */
+class PtyModule
+{
+public:
+  /* Constructor(s) and  Destructor*/
+  PtyModule(const char *mac = "001122334455", const char *firmware = "HMSoft V540") :
+    mac_(mac), firmware_(firmware)
+  {
+    if (openpty(&master_, &slave_, device_, NULL, NULL) != 0) {master_ = -1; return;}
+    fcntl(master_, F_SETFL, fcntl(master_, F_GETFL) | O_NONBLOCK);   // see respond()
+    settings_["POWE"] = "2";
+    thread_ = std::thread(&PtyModule::run, this);
+  };
+  ~PtyModule()
+  {
+    stop_ = true;
+    if (thread_.joinable()) thread_.join();
+    unplug();
+    if (slave_ >= 0) close(slave_);
+  };
+
+  /* Public member functions */
+  const char *getDevice() {return device_;}
+  void setScanRecords(uint16_t count, uint16_t spacing = 200)  // "OK+DISC:" lines per DISI?, spacing in us
+  {
+    scanCount_ = count;
+    scanSpacing_ = spacing;
+  }
+  std::string getSetting(const char *name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return settings_[name];
+  }
+  uint32_t getCommandCount() {return commands_;}
+  void unplug()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (master_ >= 0) close(master_);
+    master_ = -1;
+  }
+
+private:
+  /* Private constant declerations (static) */
+  static const int COMMAND_GAP = 5;   // in ms
+
+  /* Private member data */
+  int master_ = -1;
+  int slave_ = -1;               // kept open -> no hangup on the master side before the backend opens the device
+  char device_[64] = "";
+  std::string mac_;
+  std::string firmware_;
+  std::map<std::string, std::string> settings_;
+  uint16_t scanCount_ = 0;
+  uint16_t scanSpacing_ = 200;
+  std::atomic<bool> stop_{false};
+  std::atomic<uint32_t> commands_{0};
+  std::mutex mutex_;
+  std::thread thread_;
+
+  /* Private member functions */
+  void run()
+  {
+    std::string command;
+    while (!stop_)
+    {
+      int fd;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fd = master_;
+      }
+      if (fd < 0) return;
+      struct pollfd pfd = {fd, POLLIN, 0};
+      char c;
+      if (poll(&pfd, 1, COMMAND_GAP) > 0 && read(fd, &c, 1) == 1) command += c;
+      else if (!command.empty()) {process(fd, command); command.clear();}
+    }
+  }
+
+  void respond(int fd, const std::string &response)  // waits while the pty is full, but not beyond the destructor
+  {
+    size_t sent = 0;
+    while (sent < response.size() && !stop_)
+    {
+      ssize_t n = write(fd, response.data() + sent, response.size() - sent);
+      if (n > 0) {sent += size_t(n); continue;}
+      if (n < 0 && errno != EAGAIN) return;
+      struct pollfd pfd = {fd, POLLOUT, 0};
+      poll(&pfd, 1, COMMAND_GAP);
+    }
+  }
+
+  void process(int fd, const std::string &cmd)
+  {
+    commands_++;
+    if (cmd == "AT") {respond(fd, "OK"); return;}
+    if (cmd.compare(0, 3, "AT+") != 0 || cmd.size() < 5) return;
+    std::string verb = cmd.substr(3);
+    bool query = (verb[verb.size() - 1] == '?');
+    if (query) verb.erase(verb.size() - 1);
+
+    if (verb == "ADDR" && query) respond(fd, "OK+ADDR:" + mac_);
+    else if (verb == "VERS" && query) respond(fd, firmware_);
+    else if (verb == "RENEW" || verb == "RESET") respond(fd, "OK+" + verb);
+    else if (verb == "DISI" && query) scan(fd);
+    else
+    {
+      std::string name = verb.substr(0, 4);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!query) settings_[name] = verb.substr(4);
+      std::string value = settings_.count(name) ? settings_[name] : "0";
+      respond(fd, (query ? "OK+Get:" : "OK+Set:") + value);
+    }
+  }
+
+  void scan(int fd)
+  {
+    respond(fd, "OK+DISIS");
+    for (uint16_t i = 0; i < scanCount_ && !stop_; i++)
+    {
+      char line[96];
+      snprintf(line, sizeof(line), "OK+DISC:4C000215:74278BDAB64445208F0C720EAF059935:%04X%04XC5:%012X:-%03d",
+        1, unsigned(i % 100), unsigned(i % 50), 60 + i % 30);
+      respond(fd, line);
+      if (scanSpacing_) usleep(scanSpacing_);
+    }
+    respond(fd, "OK+DISCE");
+  }
+};
+
+#endif
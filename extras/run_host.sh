@@ -0,0 +1,91 @@
+#!/bin/sh
+# Builds and runs the host tests (extras/test) and benchmarks (extras/bench)
+# with g++ against the compat core in extras/host.
+#
+# usage: extras/run_host.sh [check|test|gates|bench] [name ...]
+#   extras/run_host.sh                 -> header check, all tests, gate matrix, then all benchmarks
+#   extras/run_host.sh check           -> compiles every HM11*.h on its own (host ones included, AVR only ones not)
+#   extras/run_host.sh test            -> all tests
+#   extras/run_host.sh gates [full]    -> links and runs test_gates against HM11.cpp with all gates on,
+#                                         each gate off on its own and all gates off (full: all 32 combinations)
+#   extras/run_host.sh bench codec     -> extras/bench/bench_codec.cpp
+# CXX and CXXFLAGS can be overridden, the binaries go to $BUILD (default /tmp/hm11_host).
+
+cd "$(dirname "$0")/.." || exit 1
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=gnu++11 -O2 -Wall -Wextra}
+BUILD=${BUILD:-/tmp/hm11_host}
+GATES="DETECTOR CONNECTION HANDSHAKING RENEW ENERGY"
+mkdir -p "$BUILD" || exit 1
+
+run() # $1 = kind (test|bench), $2 = source
+{
+  name=$(basename "$2" .cpp)
+  echo "== $name"
+  $CXX $CXXFLAGS -Iextras/host -I. "$2" HM11*.cpp -o "$BUILD/$name" -lpthread || return 1
+  timeout 300 "$BUILD/$name"   # a hanging test fails too
+}
+
+check() # every header has to compile on its own without warnings
+{
+  rc=0
+  for h in HM11*.h; do
+    case $h in HM11_SoftwareSerial*) continue;; esac   # need the AVR SoftwareSerial libraries
+    echo "#include \"$h\"" | $CXX $CXXFLAGS -Werror -fsyntax-only -Iextras/host -I. -x c++ - || { echo "in $h"; rc=1; }
+  done
+  [ $rc = 0 ] && echo "headers OK"
+  return $rc
+}
+
+gate() # $1 = name, $2.. = -D flags
+{
+  name=$1
+  shift
+  echo "== test_gates $name"
+  $CXX $CXXFLAGS "$@" -Iextras/host -I. extras/test/test_gates.cpp HM11.cpp -o "$BUILD/test_gates" || return 1
+  out=$(timeout 300 "$BUILD/test_gates")
+  result=$?
+  echo "$out" | tail -n 1
+  return $result
+}
+
+gates() # $1 = full -> all combinations (like extras/size.sh)
+{
+  rc=0
+  if [ "$1" = full ]; then
+    for n in $(seq 0 31); do
+      flags=""
+      name=""
+      i=0
+      for g in $GATES; do
+        bit=$(( (n >> i) & 1 ))
+        flags="$flags -DHM11_FEATURE_$g=$bit"
+        [ $bit = 0 ] && name="$name -$g"
+        i=$((i + 1))
+      done
+      name=${name# }
+      gate "${name:-all on}" $flags || rc=1
+    done
+  else
+    gate "all on" || rc=1
+    for g in $GATES; do gate "-$g" -DHM11_FEATURE_$g=0 || rc=1; done
+    off=""
+    for g in $GATES; do off="$off -DHM11_FEATURE_$g=0"; done
+    gate "all off" $off || rc=1
+  fi
+  return $rc
+}
+
+kinds=${1:-"check test gates bench"}
+[ $# -gt 0 ] && shift
+status=0
+for kind in $kinds; do
+  if [ "$kind" = check ]; then check || status=1; continue; fi
+  if [ "$kind" = gates ]; then gates "$@" || status=1; continue; fi
+  if [ $# -gt 0 ]; then
+    for n in "$@"; do run "$kind" "extras/$kind/${kind}_$n.cpp" || status=1; done
+  else
+    for src in extras/$kind/*.cpp; do [ -e "$src" ] && { run "$kind" "$src" || status=1; }; done
+  fi
+done
+exit $status
@@ -0,0 +1,62 @@
+#!/bin/sh
+# Flash / RAM footprint of HM11.cpp for the ATmega328P over the feature gate
+# matrix (HM11_FEATURE_* in HM11.h), measured with avr-g++ -Os and avr-size.
+# The numbers are the text / data / bss of the object file, i.e. what the
+# library adds to a sketch before --gc-sections drops unused functions. The
+# debug prints are disabled (-DHM11_DEBUG=0), so no SoftwareSerial3 is needed.
+#
+# usage: extras/size.sh [full]
+#   extras/size.sh        -> all gates on, each gate off on its own, all gates off
+#   extras/size.sh full   -> all 32 combinations
+# Needs avr-g++ / avr-size in the PATH (e.g. the ones of the Arduino IDE) and
+# the Arduino AVR core: ARDUINO_AVR_CORE defaults to the newest one in
+# ~/.arduino15/packages/arduino/hardware/avr. MCU and F_CPU can be overridden.
+
+cd "$(dirname "$0")/.." || exit 1
+CXX=${CXX:-avr-g++}
+SIZE=${SIZE:-avr-size}
+MCU=${MCU:-atmega328p}
+F_CPU=${F_CPU:-16000000L}
+ARDUINO_AVR_CORE=${ARDUINO_AVR_CORE:-$(ls -d "$HOME"/.arduino15/packages/arduino/hardware/avr/* 2>/dev/null | sort -V | tail -n 1)}
+BUILD=${BUILD:-/tmp/hm11_size}
+GATES="DETECTOR CONNECTION HANDSHAKING RENEW ENERGY"
+
+command -v "$CXX" >/dev/null && command -v "$SIZE" >/dev/null || { echo "$CXX / $SIZE not found"; exit 1; }
+[ -f "$ARDUINO_AVR_CORE/cores/arduino/Arduino.h" ] || { echo "no Arduino AVR core, set ARDUINO_AVR_CORE"; exit 1; }
+mkdir -p "$BUILD" || exit 1
+
+measure() # $1 = name, $2.. = -D flags
+{
+  name=$1
+  shift
+  $CXX -c -std=gnu++11 -Os -mmcu="$MCU" -DF_CPU="$F_CPU" -DARDUINO=10819 -DARDUINO_ARCH_AVR \
+    -fno-exceptions -fno-threadsafe-statics -ffunction-sections -fdata-sections -DHM11_DEBUG=0 \
+    -I"$ARDUINO_AVR_CORE/cores/arduino" -I"$ARDUINO_AVR_CORE/variants/standard" -I. \
+    "$@" HM11.cpp -o "$BUILD/HM11.o" || return 1
+  "$SIZE" "$BUILD/HM11.o" | awk -v name="$name" 'NR == 2 {printf "%-50s %6d %6d %6d\n", name, $1, $2, $3}'
+}
+
+printf "%-50s %6s %6s %6s\n" "configuration" text data bss
+status=0
+if [ "$1" = full ]; then
+  for n in $(seq 0 31); do
+    flags=""
+    name=""
+    i=0
+    for g in $GATES; do
+      bit=$(( (n >> i) & 1 ))
+      flags="$flags -DHM11_FEATURE_$g=$bit"
+      [ $bit = 0 ] && name="$name -$g"
+      i=$((i + 1))
+    done
+    name=${name# }
+    measure "${name:-all on}" $flags || status=1
+  done
+else
+  measure "all on" || status=1
+  for g in $GATES; do measure "-$g" -DHM11_FEATURE_$g=0 || status=1; done
+  off=""
+  for g in $GATES; do off="$off -DHM11_FEATURE_$g=0"; done
+  measure "all off" $off || status=1
+fi
+exit $status
@@ -0,0 +1,111 @@
+/*******************************************************************************
+* \file    test_codec.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Round trip and resync of HM11_Codec
+*
+* \section DESCRIPTION
+* A random walk has to survive encode() / decode() exactly, including the
+* wrap-around of the deltas. A byte lost on the link has to cost at most
+* the frames up to the next keyframe, from there on the values have to be
+* exact again (the loss itself is not always detected, the misaligned deltas
+* may look valid). A lost keyframe marker has to be detected and cost the
+* frames up to the next keyframe without a wrong one. Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include <vector>
+#include "HM11_Codec.h"
+
+/* ======================= Module constant declaration ====================== */
+static const uint16_t FRAMES = 1000;
+static const uint8_t CHANNELS = 5;
+static const uint16_t LOST_FRAME = 300;   // loses its second byte
+static const uint16_t RESYNC_FRAME = 330;  // next keyframe (every DEFAULT_KEYFRAME_INTERVAL + 1 frames)
+static const uint16_t LOST_KEYFRAME = 594; // loses its marker -> missing keyframe has to be detected
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Codec encoder(CHANNELS);
+  HM11_Codec decoder(CHANNELS);
+  HM11_Codec lossy(CHANNELS);
+  HM11_Codec keyless(CHANNELS);
+  int16_t values[FRAMES][CHANNELS];
+  int16_t walk[CHANNELS] = {0, 100, -100, 32000, -32000};
+
+  uint16_t exact = 0;
+  uint16_t lossyWrong = 0;
+  uint16_t lastWrongFrame = 0;
+  uint16_t keylessFrames = 0;
+  for (uint16_t f = 0; f < FRAMES; f++)
+  {
+    for (uint8_t c = 0; c < CHANNELS; c++)
+    {
+      walk[c] = int16_t(uint16_t(walk[c]) + uint16_t(random(-300, 301)));   // wraps at the ends
+      values[f][c] = walk[c];
+    }
+    uint8_t frame[HM11_Codec::MAX_FRAME_SIZE];
+    uint8_t length = encoder.encode(values[f], frame);
+    CHECK(length <= HM11_Codec::MAX_FRAME_SIZE);
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+      if (decoder.decode(frame[i]) && memcmp(decoder.getValues(), values[f], sizeof(values[f])) == 0) exact++;
+      bool lost = (f == LOST_FRAME && i == 1);
+      if (!lost && lossy.decode(frame[i]) && memcmp(lossy.getValues(), values[f], sizeof(values[f])) != 0)
+      {
+        lossyWrong++;
+        lastWrongFrame = f;
+      }
+      lost = (f == LOST_KEYFRAME && i == 0);
+      if (!lost && keyless.decode(frame[i]))
+      {
+        keylessFrames++;
+        CHECK(memcmp(keyless.getValues(), values[f], sizeof(values[f])) == 0);
+      }
+    }
+  }
+
+  CHECK(exact == FRAMES);
+  CHECK(decoder.getDecoderStats()->errors == 0);
+  CHECK(decoder.getDecoderStats()->frames == FRAMES);
+  CHECK(encoder.getEncoderStats()->keyframes == (FRAMES + HM11_Codec::DEFAULT_KEYFRAME_INTERVAL) / (HM11_Codec::DEFAULT_KEYFRAME_INTERVAL + 1));
+  CHECK(decoder.getDecoderStats()->keyframes == encoder.getEncoderStats()->keyframes);
+
+  /* the loss costs the frames up to the next keyframe only */
+  CHECK(lossy.getDecoderStats()->errors <= 1);
+  CHECK(lastWrongFrame < RESYNC_FRAME);
+  CHECK(lossy.getDecoderStats()->frames > FRAMES - (RESYNC_FRAME - LOST_FRAME));
+  CHECK(keyless.getDecoderStats()->errors == 1);
+  CHECK(keylessFrames == FRAMES - (HM11_Codec::DEFAULT_KEYFRAME_INTERVAL + 1));
+  CHECK(keyless.getDecoderStats()->skippedBytes > 0);
+
+  printf("lost frame %u: %u wrong frames (last %u), %u errors, %u bytes skipped\n", LOST_FRAME, lossyWrong,
+    lastWrongFrame, unsigned(lossy.getDecoderStats()->errors), unsigned(lossy.getDecoderStats()->skippedBytes));
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+* \file    test_demux.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Module notifications split over time and mixed into the data
+*
+* \section DESCRIPTION
+* HM11_Simulator sends "OK+CONN", "OK+CONNF", "OK+CONNE" and "OK+LOST" in
+* pieces with pauses shorter than CONN_SETTLE_TIME, mixed into application
+* data. pollConnection() and readData() have to dispatch exactly the events
+* that were sent ("OK+CONN" only after the settle time without A/F/E) and
+* hand out all other characters as data. Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include <string>
+#include <vector>
+#include "HM11_Simulator.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================== Module variable definitions ===================== */
+static std::vector<HM11::event_t> events;
+
+/* ======================== Module function definitions ===================== */
+static void onEvent(HM11::event_t event, void *)
+{
+  events.push_back(event);
+}
+
+static void poll(HM11_Simulator &ble, uint32_t ms)  // pollConnection() in the main loop
+{
+  for (uint32_t i = 0; i < ms; i++)
+  {
+    ble.pollConnection();
+    ble.run(1);
+  }
+}
+
+static std::string read(HM11_Simulator &ble, uint32_t ms)  // readData() in the main loop
+{
+  std::string data;
+  for (uint32_t i = 0; i < ms; i++)
+  {
+    int16_t b;
+    while ((b = ble.readData()) >= 0) data += char(b);
+    ble.run(1);
+  }
+  return data;
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Simulator ble;
+  CHECK(ble.begin());
+  ble.setEventCallback(onEvent);
+  const HM11::linkStats_t *stats = ble.getLinkStats();
+
+  /* pollConnection: "OK+CONN" | pause | "F" -> failed, never connected */
+  ble.sendFromModule("OK+CONN");
+  poll(ble, 9);   // 7 characters at 9600 baud + a pause < CONN_SETTLE_TIME
+  CHECK(events.empty());
+  CHECK(ble.getLinkState() == HM11::LINK_DISCONNECTED);
+  ble.sendFromModule("F");
+  poll(ble, 30);
+  CHECK(events.size() == 1 && events[0] == HM11::EVENT_CONNECT_FAILED);
+  CHECK(ble.getLinkState() == HM11::LINK_DISCONNECTED);
+  CHECK(stats->connects == 0 && stats->failures == 1);
+
+  /* pollConnection: "OK+CO" | pause | "NN" | silence -> connected */
+  events.clear();
+  ble.sendFromModule("OK+CO");
+  poll(ble, 8);
+  ble.sendFromModule("NN");
+  poll(ble, 30);
+  CHECK(events.size() == 1 && events[0] == HM11::EVENT_CONNECTED);
+  CHECK(ble.getLinkState() == HM11::LINK_CONNECTED);
+  CHECK(stats->connects == 1);
+
+  /* readData: notifications split within the data */
+  events.clear();
+  ble.sendFromModule("ab");
+  ble.sendFromModule("OK+LO");
+  std::string data = read(ble, 12);
+  CHECK(data == "ab");   // "OK+LO" held
+  CHECK(events.empty());
+  ble.sendFromModule("STcd");
+  data = read(ble, 30);
+  CHECK(data == "cd");
+  CHECK(events.size() == 1 && events[0] == HM11::EVENT_LOST);
+  CHECK(ble.getLinkState() == HM11::LINK_DISCONNECTED);
+
+  /* readData: "OK+CONN" | pause | "E" -> failed, "OK+CONN" | silence -> connected */
+  events.clear();
+  ble.sendFromModule("xOK+CONN");
+  data = read(ble, 12);
+  ble.sendFromModule("Ey");
+  data += read(ble, 30);
+  CHECK(data == "xy");
+  CHECK(events.size() == 1 && events[0] == HM11::EVENT_CONNECT_FAILED);
+  ble.sendFromModule("OK+CONN");
+  data = read(ble, 30);
+  CHECK(data.empty());
+  CHECK(events.size() == 2 && events[1] == HM11::EVENT_CONNECTED);
+  CHECK(ble.getLinkState() == HM11::LINK_CONNECTED);
+
+  /* readData: near misses are data */
+  events.clear();
+  ble.sendFromModule("OK+COFFEE OK");
+  data = read(ble, 40);
+  CHECK(data == "OK+COFFEE OK");
+  CHECK(events.empty());
+
+  /* a real connect: "OK+CONNA" -> "OK+CONN" via connectToMacAddress, then "OK+LOST" */
+  HM11_Simulator central;
+  HM11_Simulator::device_t peer = {"A1B2C3D4E5F6", NULL, 0, 0, 0, -60, 100, 0, "peer", true};
+  central.addDevice(peer);
+  CHECK(central.begin());
+  events.clear();
+  central.setEventCallback(onEvent);
+  CHECK(central.connectToMacAddress("A1B2C3D4E5F6", true) == HM11::STATUS_OK);
+  CHECK(events.size() == 1 && events[0] == HM11::EVENT_CONNECTED);
+  central.dropLink();
+  CHECK(read(central, 30).empty());
+  CHECK(events.size() == 2 && events[1] == HM11::EVENT_LOST);
+  CHECK(central.getLinkState() == HM11::LINK_DISCONNECTED);
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
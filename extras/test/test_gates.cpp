@@ -0,0 +1,92 @@
+/*******************************************************************************
+* \file    test_gates.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Uses the API of every enabled feature gate against HM11_Simulator
+*
+* \section DESCRIPTION
+* Calls at least one function of each part of the API which the header
+* declares for the current HM11_FEATURE_* configuration. Built over the gate
+* matrix by "extras/run_host.sh gates" (together with HM11.cpp only), so a
+* definition which ended up behind the wrong gate fails to link. Returns 0
+* if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Simulator.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ================================== Main ================================== */
+int main()
+{
+  printf("DETECTOR=%d CONNECTION=%d HANDSHAKING=%d RENEW=%d ENERGY=%d\n", HM11_FEATURE_DETECTOR,
+    HM11_FEATURE_CONNECTION, HM11_FEATURE_HANDSHAKING, HM11_FEATURE_RENEW, HM11_FEATURE_ENERGY);
+
+  HM11_Simulator ble;
+  ble.setMacAddress("A1B2C3D4E5F6");
+  CHECK(ble.begin());
+  CHECK(ble.setTxPower(HM11::POWER_0DBM) == HM11::STATUS_OK);
+  CHECK(ble.refreshConf());
+  CHECK(ble.getPIO(2) >= 0);
+
+  /* always there */
+  HM11::moduleState_t awake = ble.getModuleState();
+  CHECK(awake != HM11::STATE_DISABLED);
+  CHECK(ble.sleepBLE() == HM11::STATUS_OK);
+  CHECK(ble.getModuleState() == HM11::STATE_SLEEPING);
+  CHECK(ble.wakeUpBLE());
+  CHECK(ble.getModuleState() == awake);
+  CHECK(ble.recover() == HM11::RECOVERY_PING);
+
+#if HM11_FEATURE_ENERGY
+  ble.resetEnergy();
+  ble.run(1000);
+  CHECK(ble.getStateTime(ble.getModuleState()) >= 1000);
+  (void)ble.getCharge();
+#endif
+
+#if HM11_FEATURE_DETECTOR
+  CHECK(ble.setupAsIBeaconDetector() == HM11::STATUS_OK);
+  CHECK(ble.startIBeaconScan(500));
+  HM11::iBeaconRecord_t record;
+  HM11::scanState_t state;
+  while ((state = ble.pollIBeaconScan(&record)) == HM11::SCAN_RUNNING || state == HM11::SCAN_RECORD) {}
+  CHECK(!ble.isScanning());
+#endif
+
+#if HM11_FEATURE_CONNECTION
+  CHECK(ble.getLinkState() == HM11::LINK_DISCONNECTED);
+  (void)ble.getLinkStats();
+  ble.pollConnection();
+  CHECK(ble.readData() < 0);
+#endif
+
+#if HM11_FEATURE_HANDSHAKING
+  (void)&HM11::handshaking;   // needs a peer, linking is enough here
+#endif
+
+  ble.end();
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
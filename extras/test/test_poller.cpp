@@ -0,0 +1,150 @@
+/*******************************************************************************
+* \file    test_poller.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   HM11_Poller against peers simulated by HM11_Simulator
+*
+* \section DESCRIPTION
+* One peer per case: a valid response, garbage and a frame with a wrong
+* checksum before the valid one (resync), only a wrong checksum, no answer,
+* an unreachable peer and a full TX queue. Every case has to end with its
+* own status and statistics counter, invalid MAC addresses are refused by
+* addPeer(). Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include <string>
+#include <vector>
+#include "HM11_Simulator.h"
+#include "HM11_Poller.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================= Module constant declaration ====================== */
+static const uint8_t REQUEST[] = {'R', 0x7E, 0x01};    // contains FRAME_START
+static const uint8_t RESPONSE[] = {'T', 0x7E, 0x21, 0x42};
+
+enum {PEER_OK, PEER_RESYNC, PEER_CHECKSUM, PEER_SILENT, PEER_UNREACHABLE, PEER_BUSY, PEER_COUNT};
+static const char *const MACS[PEER_COUNT] = {"A00000000001", "A00000000002", "A00000000003",
+  "A00000000004", "0123456789AB", "A00000000006"};
+
+/* ======================== Module variable definitions ===================== */
+static std::vector<uint8_t> answered;   // peers passed to the callback
+
+/* ======================== Module function definitions ===================== */
+static std::string frame(const uint8_t *payload, uint8_t length)
+{
+  uint8_t out[HM11_POLLER_MAX_PAYLOAD + 3];
+  uint8_t n = HM11_Poller::buildFrame(payload, length, out);
+  return std::string((const char *)out, n);
+}
+
+static std::string respond(const std::string &mac, const std::string &data, void *)
+{
+  if (data != frame(REQUEST, sizeof(REQUEST))) return "";   // the request has to arrive framed and complete
+  std::string response = frame(RESPONSE, sizeof(RESPONSE));
+  std::string corrupted = response;
+  corrupted[3] ^= 0x01;
+  if (mac == MACS[PEER_OK]) return response;
+  if (mac == MACS[PEER_RESYNC]) return std::string("\x01\x7E\xFF") + corrupted + response;  // oversized length, bad checksum
+  if (mac == MACS[PEER_CHECKSUM]) return corrupted;
+  return "";
+}
+
+static void onResponse(uint8_t peer, const uint8_t *payload, uint8_t length, void *)
+{
+  CHECK(length == sizeof(RESPONSE) && memcmp(payload, RESPONSE, length) == 0);
+  answered.push_back(peer);
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Simulator ble;
+  for (uint8_t i = 0; i < PEER_COUNT; i++)
+  {
+    HM11_Simulator::device_t device = {MACS[i], NULL, 0, 0, 0, -60, 100, 0, "peer", true};
+    if (i != PEER_UNREACHABLE) ble.addDevice(device);
+  }
+  ble.setPeerResponder(respond);
+  CHECK(ble.begin());
+  HM11_Poller poller(ble, onResponse, NULL, 1000, 200);
+  CHECK(poller.setRequest(REQUEST, sizeof(REQUEST)));
+
+  /* invalid MAC addresses */
+  CHECK(poller.addPeer("A0000000000") == -1);
+  CHECK(poller.addPeer("A000000000001") == -1);
+  CHECK(poller.addPeer("a00000000001") == -1);
+  CHECK(poller.addPeer("A0000000000G") == -1);
+  CHECK(poller.addPeer("A00000:00001") == -1);
+  CHECK(poller.getPeerCount() == 0);
+  uint32_t commands = ble.getModuleCommands();
+  CHECK(ble.connectToMacAddress("A0000000000G", true) == HM11::STATUS_INVALID);
+  CHECK(ble.getModuleCommands() == commands);
+  for (uint8_t i = 0; i < PEER_COUNT; i++) CHECK(poller.addPeer(MACS[i]) == int8_t(i));
+
+  /* one exchange per peer */
+  CHECK(poller.pollPeer(PEER_OK) == HM11::STATUS_OK);
+  CHECK(poller.pollPeer(PEER_RESYNC) == HM11::STATUS_OK);
+  CHECK(poller.pollPeer(PEER_CHECKSUM) == HM11::STATUS_TIMEOUT);
+  CHECK(poller.pollPeer(PEER_SILENT) == HM11::STATUS_TIMEOUT);
+  CHECK(poller.pollPeer(PEER_UNREACHABLE) != HM11::STATUS_OK);
+  CHECK(ble.getLinkState() == HM11::LINK_DISCONNECTED);
+
+  /* the application filled the TX queue -> not sent as a partial frame, not a timeout */
+  uint8_t fill[HM11_TX_BUFFER_SIZE];
+  memset(fill, 'x', sizeof(fill));
+  CHECK(ble.write(fill, sizeof(fill)) == sizeof(fill));
+  uint32_t airBytes = ble.getAirBytes();
+  CHECK(poller.pollPeer(PEER_BUSY) == HM11::STATUS_BUSY);
+  CHECK(ble.getAirBytes() == airBytes);
+  CHECK(ble.getLinkState() == HM11::LINK_DISCONNECTED);
+  CHECK(poller.pollPeer(PEER_BUSY) == HM11::STATUS_TIMEOUT);   // queue discarded, the request went out (no response)
+  CHECK(poller.pollPeer(PEER_COUNT) == HM11::STATUS_INVALID);
+
+  for (uint8_t i = 0; i < PEER_COUNT; i++)
+  {
+    const HM11_Poller::peerStats_t *s = poller.getPeerStats(i);
+    printf("peer %u: %u polls, %u connect failures, %u write failures, %u timeouts, %u ms\n", unsigned(i),
+      unsigned(s->polls), unsigned(s->connectFailures), unsigned(s->writeFailures), unsigned(s->timeouts), unsigned(s->timeSum));
+  }
+  CHECK(answered.size() == 2 && answered[0] == PEER_OK && answered[1] == PEER_RESYNC);
+  CHECK(poller.getPeerStats(PEER_OK)->polls == 1);
+  CHECK(poller.getPeerStats(PEER_RESYNC)->polls == 1);
+  CHECK(poller.getPeerStats(PEER_CHECKSUM)->timeouts == 1 && poller.getPeerStats(PEER_CHECKSUM)->polls == 0);
+  CHECK(poller.getPeerStats(PEER_SILENT)->timeouts == 1);
+  CHECK(poller.getPeerStats(PEER_UNREACHABLE)->connectFailures == 1 && poller.getPeerStats(PEER_UNREACHABLE)->timeouts == 0);
+  CHECK(poller.getPeerStats(PEER_BUSY)->writeFailures == 1 && poller.getPeerStats(PEER_BUSY)->timeouts == 1);
+  CHECK(poller.getPeerStats(PEER_UNREACHABLE)->lastTime >= 1000);   // connect timeout
+  CHECK(poller.getPeerStats(PEER_SILENT)->lastTime >= 200);         // response timeout
+  CHECK(poller.getPeerStats(PEER_COUNT) == NULL);
+
+  /* a whole cycle */
+  answered.clear();
+  CHECK(poller.pollCycle() == 2);
+  CHECK(poller.getCycleStats()->cycles == 1);
+  CHECK(poller.getCycleStats()->lastTime >= 1000 + 3 * 200);
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************
+* \file    test_posix_pty.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   HM11_PosixSerial against a fake module behind a pty
+*
+* \section DESCRIPTION
+* begin(), the read-backs and a setting over a real tty (PtyModule), then
+* the adapter gets unplugged: the next command has to fail within the
+* timeouts and getError() has to report the I/O error instead of the
+* backend looping in BLESerial_write(). Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_PosixSerial.h"
+#include "PtyModule.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ================================== Main ================================== */
+int main()
+{
+  PtyModule module("A1B2C3D4E5F6", "HMSoft V540");
+  HM11_PosixSerial ble(module.getDevice());
+
+  CHECK(ble.begin());
+  CHECK(ble.getError() == 0);
+  CHECK(ble.getFirmwareVersion() == 540);
+  String mac;
+  HM11::txPower_t power = HM11::POWER_N23DBM;
+  CHECK(ble.getMacAddress(mac) == HM11::STATUS_OK && mac == "A1B2C3D4E5F6");
+  CHECK(ble.getTxPower(power) == HM11::STATUS_OK && power == HM11::POWER_0DBM);
+  CHECK(ble.setTxPower(HM11::POWER_6DBM) == HM11::STATUS_OK);
+  CHECK(module.getSetting("POWE") == "3");
+
+  /* unplugged -> fails with the I/O error instead of hanging */
+  module.unplug();
+  uint32_t ms = ble.getMillis();
+  CHECK(ble.setTxPower(HM11::POWER_N6DBM) != HM11::STATUS_OK);
+  uint32_t dt = ble.getMillis() - ms;
+  CHECK(dt < 2000);
+  CHECK(ble.getError() != 0);
+  printf("unplugged: failed after %u ms, errno %d (%s)\n", dt, ble.getError(), strerror(ble.getError()));
+  CHECK(ble.getTxPower(power) != HM11::STATUS_OK);   // failed set -> not shadowed, read fails
+  CHECK(power == HM11::POWER_0DBM);                  // unchanged
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+/*******************************************************************************
+* \file    test_reconnect.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Auto reconnect of pollConnection() against HM11_Simulator
+*
+* \section DESCRIPTION
+* pollConnection() is called in a main loop (1 ms per round): after a lost
+* link it has to reconnect without blocking the loop, and an unreachable
+* peer has to be retried with a growing backoff, each attempt given up after
+* the timeout of setAutoReconnect(). Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Simulator.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================== Module function definitions ===================== */
+static uint32_t loop(HM11_Simulator &ble, uint32_t ms)  // returns the longest pollConnection() call in us
+{
+  uint32_t longest = 0;
+  uint64_t until = ble.getMicros() + uint64_t(ms) * 1000;
+  while (ble.getMicros() < until)
+  {
+    uint64_t t = ble.getMicros();
+    if (ble.getLinkState() == HM11::LINK_CONNECTED) ble.readData();   // tracks "OK+LOST"
+    else ble.pollConnection();
+    if (ble.getMicros() - t > longest) longest = uint32_t(ble.getMicros() - t);
+    ble.run(1);
+  }
+  return longest;
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  /* lost link -> reconnected without blocking the loop */
+  HM11_Simulator ble;
+  HM11_Simulator::device_t peer = {"A1B2C3D4E5F6", NULL, 0, 0, 0, -60, 100, 0, "peer", true};
+  ble.addDevice(peer);
+  CHECK(ble.begin());
+  CHECK(ble.connectToMacAddress("A1B2C3D4E5F6", true) == HM11::STATUS_OK);
+  ble.setAutoReconnect(true);
+  ble.dropLink();
+  uint32_t longest = loop(ble, 2000);
+  printf("reconnect: longest pollConnection() %u us\n", longest);
+  CHECK(ble.getLinkState() == HM11::LINK_CONNECTED);
+  CHECK(ble.getLinkStats()->connects == 2);
+  CHECK(ble.getLinkStats()->drops == 1);
+  CHECK(longest < 20000);   // "AT+CON" at 9600 baud, no waiting for the link
+
+  /* unreachable peer (answers "OK+CONNF" after 10s) -> timeout after 500ms, backoff 0.5, 1, 2, 4, 8s */
+  HM11_Simulator lonely;
+  CHECK(lonely.begin());
+  CHECK(lonely.connectToMacAddress("0123456789AB", true, 100) == HM11::STATUS_NOT_CONNECTED);
+  CHECK(lonely.getLinkStats()->failures == 1);
+  lonely.setAutoReconnect(true, 500);
+  uint32_t commands = lonely.getModuleCommands();
+  longest = loop(lonely, 20000);
+  printf("unreachable: longest pollConnection() %u us, %u attempts\n", longest, unsigned(lonely.getLinkStats()->failures - 1));
+  CHECK(lonely.getLinkState() == HM11::LINK_DISCONNECTED);
+  CHECK(lonely.getLinkStats()->failures == 1 + 5);   // 0.5 + 1 + 2 + 4 + 8 backoff + 5 * 0.5 timeout < 20s
+  CHECK(lonely.getModuleCommands() == commands + 2 * 5);   // "AT+CON" and the "AT" which cancels it
+  CHECK(longest < 20000);
+
+  /* disabled -> no more attempts */
+  lonely.setAutoReconnect(false);
+  commands = lonely.getModuleCommands();
+  loop(lonely, 5000);
+  CHECK(lonely.getModuleCommands() == commands);
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
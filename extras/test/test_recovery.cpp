@@ -0,0 +1,124 @@
+/*******************************************************************************
+* \file    test_recovery.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Recovery ladder of recover() against HM11_Simulator
+*
+* \section DESCRIPTION
+* One fault per step of the ladder: recover() has to stop at the first step
+* which fixes it (the cheaper ones are tried before, the more expensive ones
+* are not reached, e.g. no HW reset for a busy UART) and getRecoveryStats()
+* has to record that step and its duration. A hung module goes through the
+* whole ladder and is reported as RECOVERY_FAILED. Returns 0 if all checks
+* passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Simulator.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================== Module function definitions ===================== */
+static HM11::recoveryStep_t recover(HM11_Simulator &ble, const char *fault, uint32_t &resets)
+{
+  uint32_t before = ble.getModuleResets();
+  HM11::recoveryStep_t step = ble.recover();
+  resets = ble.getModuleResets() - before;
+  printf("%-10s -> step %u after %u ms, %u module resets\n", fault, unsigned(step),
+    unsigned(ble.getRecoveryStats()->lastDuration), unsigned(resets));
+  return step;
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Simulator::timing_t timing = HM11_Simulator::defaultTiming();
+  timing.scanTime = 100;
+  HM11_Simulator ble(&timing);
+  HM11_Simulator::device_t beacon = {"A1B2C3D4E5F6", "74278BDAB64445208F0C720EAF059935", 1, 2, -59, -60, 20, 0, "beacon", false};
+  ble.addDevice(beacon);
+  CHECK(ble.begin());
+  const HM11::recoveryStats_t *stats = ble.getRecoveryStats();
+  uint32_t resets;
+  uint16_t duration[HM11::RECOVERY_FAILED + 1];
+
+  /* healthy -> "AT" is enough */
+  CHECK(recover(ble, "healthy", resets) == HM11::RECOVERY_PING);
+  CHECK(resets == 0);
+  duration[HM11::RECOVERY_PING] = stats->lastDuration;
+
+  /* scan left running, its records still in the UART -> flushed, no reset */
+  CHECK(ble.setupAsIBeaconDetector() == HM11::STATUS_OK);
+  CHECK(ble.startIBeaconScan(1));
+  ble.run(200);
+  CHECK(recover(ble, "scan", resets) == HM11::RECOVERY_RESYNC);
+  CHECK(resets == 0);
+  CHECK(!ble.isScanning());
+  duration[HM11::RECOVERY_RESYNC] = stats->lastDuration;
+
+  /* asleep, "AT" is ignored -> HW reset, baudrate untouched */
+  CHECK(ble.sleepBLE() == HM11::STATUS_OK);
+  uint32_t commands = ble.getModuleCommands();
+  CHECK(recover(ble, "asleep", resets) == HM11::RECOVERY_HW_RESET);
+  CHECK(resets == 1);
+  CHECK(ble.getModuleCommands() == commands + 2);   // "AT" once booted and the check of the step, no setting
+  duration[HM11::RECOVERY_HW_RESET] = stats->lastDuration;
+
+  /* baudrate changed behind our back (active after the reset too) -> detected and restored */
+  ble.setModuleBaudrate(HM11::BAUDRATE4);
+  CHECK(recover(ble, "baudrate", resets) == HM11::RECOVERY_BAUDRATE);
+  CHECK(ble.setTxPower(HM11::POWER_0DBM) == HM11::STATUS_OK);   // talking at the configured baudrate again
+  duration[HM11::RECOVERY_BAUDRATE] = stats->lastDuration;
+
+  /* hung -> every step tried, nothing helps */
+  ble.setHung(true);
+  CHECK(recover(ble, "hung", resets) == HM11::RECOVERY_FAILED);
+  CHECK(resets == 1);   // only the HW reset, nothing answers to "AT+RENEW"
+  duration[HM11::RECOVERY_FAILED] = stats->lastDuration;
+
+  /* the later the step, the longer it took (a hung module skips the RENEW delays of setBaudrate) */
+  CHECK(duration[HM11::RECOVERY_PING] > 0);
+  CHECK(duration[HM11::RECOVERY_PING] < duration[HM11::RECOVERY_RESYNC]);
+  CHECK(duration[HM11::RECOVERY_RESYNC] < duration[HM11::RECOVERY_HW_RESET]);
+  CHECK(duration[HM11::RECOVERY_HW_RESET] < duration[HM11::RECOVERY_BAUDRATE]);
+  CHECK(duration[HM11::RECOVERY_HW_RESET] < duration[HM11::RECOVERY_FAILED]);
+  CHECK(stats->maxDuration == duration[HM11::RECOVERY_BAUDRATE]);
+
+  /* one call recorded per step */
+  CHECK(stats->lastStep == HM11::RECOVERY_FAILED);
+  CHECK(stats->steps[HM11::RECOVERY_PING] == 1);
+  CHECK(stats->steps[HM11::RECOVERY_RESYNC] == 1);
+  CHECK(stats->steps[HM11::RECOVERY_HW_RESET] == 1);
+  CHECK(stats->steps[HM11::RECOVERY_BAUDRATE] == 1);
+  CHECK(stats->steps[HM11::RECOVERY_RENEW] == 0);
+  CHECK(stats->steps[HM11::RECOVERY_FAILED] == 1);
+
+  /* back to normal -> "AT" again, the maximum is kept */
+  ble.setHung(false);
+  CHECK(recover(ble, "healthy", resets) == HM11::RECOVERY_PING);
+  CHECK(stats->lastStep == HM11::RECOVERY_PING && stats->steps[HM11::RECOVERY_PING] == 2);
+  CHECK(stats->maxDuration == duration[HM11::RECOVERY_BAUDRATE]);
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+* \file    test_replay.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Capture with HM11_Trace, replay with HM11_Replay
+*
+* \section DESCRIPTION
+* A session against HM11_Simulator is captured, then replayed: the same
+* calls have to return the same results without a mismatch and consume the
+* whole trace. A session which sends another command has to fail with the
+* position of the first differing byte instead of stalling. Returns 0 if
+* all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include <vector>
+#include "HM11_Replay.h"
+#include "HM11_Simulator.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================== Module function definitions ===================== */
+static void writeTrace(const uint8_t *data, uint8_t length, void *context)
+{
+  std::vector<uint8_t> *trace = (std::vector<uint8_t> *)context;
+  trace->insert(trace->end(), data, data + length);
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  /* capture */
+  std::vector<uint8_t> trace;
+  HM11_Trace<HM11_Simulator> field;
+  field.setMacAddress("A1B2C3D4E5F6");
+  field.setTraceWriter(writeTrace, &trace);
+  CHECK(field.begin());
+  String mac;
+  CHECK(field.getMacAddress(mac) == HM11::STATUS_OK);
+  HM11::status_t status = field.setTxPower(HM11::POWER_6DBM);
+  field.setTraceWriter(NULL);
+  CHECK(mac == "A1B2C3D4E5F6");
+  CHECK(status == HM11::STATUS_OK);
+  printf("trace: %u bytes\n", unsigned(trace.size()));
+
+  /* same session -> same results, whole trace consumed */
+  HM11_Replay replay(trace.data(), uint32_t(trace.size()));
+  CHECK(replay.isValid());
+  CHECK(replay.begin());
+  String replayed;
+  CHECK(replay.getMacAddress(replayed) == HM11::STATUS_OK && replayed == mac);
+  CHECK(replay.setTxPower(HM11::POWER_6DBM) == status);
+  CHECK(replay.getMismatchCount() == 0);
+  CHECK(!replay.hasDiverged());
+  CHECK(replay.isFinished());
+
+  /* another power -> fails at the power digit instead of stalling */
+  HM11_Replay diverging(trace.data(), uint32_t(trace.size()));
+  CHECK(diverging.begin());
+  CHECK(diverging.getMacAddress(replayed) == HM11::STATUS_OK && replayed == mac);
+  CHECK(diverging.setTxPower(HM11::POWER_N6DBM) != HM11::STATUS_OK);
+  CHECK(diverging.hasDiverged());
+  CHECK(!diverging.isFinished());
+  const HM11_Replay::divergence_t &divergence = diverging.getDivergence();
+  CHECK(divergence.expected == '3');
+  CHECK(divergence.actual == '1');
+  CHECK(divergence.position < trace.size());
+  printf("diverged at trace byte %u (event %u): expected 0x%02X, sent 0x%02X, %u us virtual\n",
+    unsigned(divergence.position), unsigned(divergence.event), unsigned(divergence.expected),
+    unsigned(divergence.actual), unsigned(diverging.getMicros()));
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
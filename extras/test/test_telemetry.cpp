@@ -0,0 +1,88 @@
+/*******************************************************************************
+* \file    test_telemetry.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   updateTelemetry() against HM11_Simulator
+*
+* \section DESCRIPTION
+* Only changed values are sent, the limits of setupAsIBeacon apply and
+* nothing is sent unless the module is set up as iBeacon and idle (not a
+* detector, no link). Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include "HM11_Simulator.h"
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================== Module variable definitions ===================== */
+HM11_IBEACON_PROFILE(beacon, "HMSoft", "74278BDAB64445208F0C720EAF059935", 1, 2, HM11::INTERV_100MS, HM11::POWER_0DBM);
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Simulator ble;
+  CHECK(ble.begin());
+  const HM11::telemetryStats_t *stats = ble.getTelemetryStats();
+
+  /* not set up as iBeacon -> nothing sent */
+  uint32_t commands = ble.getModuleCommands();
+  CHECK(ble.updateTelemetry(10, 20) == HM11::STATUS_INVALID);
+  CHECK(ble.getModuleCommands() == commands);
+
+  /* only what changed */
+  CHECK(ble.setupAsIBeacon(&beacon) == HM11::STATUS_OK);
+  commands = ble.getModuleCommands();
+  CHECK(ble.updateTelemetry(10, 20) == HM11::STATUS_OK);
+  CHECK(ble.getModuleCommands() == commands + 2);
+  CHECK(ble.updateTelemetry(10, 21) == HM11::STATUS_OK);
+  CHECK(ble.getModuleCommands() == commands + 3);
+  CHECK(ble.updateTelemetry(10, 21) == HM11::STATUS_OK);
+  CHECK(ble.getModuleCommands() == commands + 3);
+  CHECK(stats->updates == 2 && stats->commands == 3);
+  CHECK(stats->lastAckLatency > 0 && stats->maxAckLatency >= stats->lastAckLatency);
+
+  /* limits of setupAsIBeacon */
+  CHECK(ble.updateTelemetry(0, 21) == HM11::STATUS_INVALID);
+  CHECK(ble.updateTelemetry(10, 0) == HM11::STATUS_INVALID);
+  CHECK(ble.updateTelemetry(0xFFFE, 21) == HM11::STATUS_INVALID);
+  CHECK(ble.updateTelemetry(10, 0xFFFF) == HM11::STATUS_INVALID);
+  CHECK(ble.updateTelemetry(0xFFFD, 0xFFFD) == HM11::STATUS_OK);
+  CHECK(ble.getModuleCommands() == commands + 5);
+
+  /* a central connected to us -> the commands would go to the peer */
+  ble.sendFromModule("OK+CONN");
+  for (uint8_t i = 0; i < 30; i++) {ble.pollConnection(); ble.run(1);}
+  CHECK(ble.getLinkState() == HM11::LINK_CONNECTED);
+  CHECK(ble.updateTelemetry(11, 22) == HM11::STATUS_BUSY);
+  ble.disconnect();
+
+  /* detector -> no longer an iBeacon */
+  CHECK(ble.setupAsIBeaconDetector() == HM11::STATUS_OK);
+  commands = ble.getModuleCommands();
+  CHECK(ble.updateTelemetry(11, 22) == HM11::STATUS_INVALID);
+  CHECK(ble.getModuleCommands() == commands);
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/*******************************************************************************
+* \file    test_uplink.cpp
+********************************************************************************
+* \author  Jascha Haldemann jh@oxon.ch
+* \date    18.10.2026
+* \version 1.0
+*
+* \brief   Round trip, corruption and late join of HM11_Uplink
+*
+* \section DESCRIPTION
+* Records of 3 UUIDs (one with another access address) are encoded into one
+* byte stream. A gateway which sees the whole stream has to decode all of
+* them exactly. After a corrupted byte and for a gateway which joins in the
+* middle of a record, every UUID and the time have to be resolved again
+* within REFRESH_INTERVAL records per UUID, both without a wrong record.
+* Returns 0 if all checks passed.
+*
+* \license LGPL-V2.1
+* Copyright (c) 2017 OXON AG. All rights reserved.
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, see 'http://www.gnu.org/licenses/'
+********************************************************************************
+* BLE Library
+*******************************************************************************/
+
+/* ================================= Imports ================================ */
+#include <vector>
+#include "HM11_Uplink.h"
+
+/* ======================= Module constant declaration ====================== */
+static const uint16_t RECORDS = 300;
+static const uint8_t UUIDS = 3;
+
+/* ========================= Module macro declaration ======================= */
+static int failures = 0;
+#define CHECK(cond) do {if (!(cond)) {printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++;}} while (0)
+
+/* ======================== Module function definitions ===================== */
+typedef struct
+{
+  HM11::iBeaconRecord_t record;
+  uint32_t timestamp;
+  size_t end;                    // stream offset after the record
+} sent_t;
+
+static bool equal(const HM11::iBeaconRecord_t *a, const HM11::iBeaconRecord_t *b)
+{
+  return memcmp(a->uuid, b->uuid, 16) == 0 && memcmp(a->mac, b->mac, 6) == 0 && a->major == b->major &&
+    a->minor == b->minor && a->accessAddress == b->accessAddress && a->measuredPower == b->measuredPower &&
+    a->rssi == b->rssi;
+}
+
+/* decodes stream[from..], returns the number of exact records, counts the wrong ones */
+static uint16_t receive(const std::vector<uint8_t> &stream, size_t from, const std::vector<sent_t> &sent,
+  uint16_t *wrong, uint16_t *firstExact)
+{
+  HM11_Uplink gateway;
+  uint16_t exact = 0;
+  *wrong = 0;
+  *firstExact = RECORDS;
+  size_t pos = from;
+  while (pos < stream.size())
+  {
+    uint8_t length = uint8_t((stream.size() - pos > 255) ? 255 : stream.size() - pos);
+    HM11::iBeaconRecord_t record;
+    uint32_t timestamp;
+    int8_t n = gateway.decode(&stream[pos], length, &record, &timestamp);
+    if (n == 0) break;
+    if (n < 0) {pos += size_t(-n); continue;}
+    pos += size_t(n);
+
+    uint16_t i = 0;
+    while (i < sent.size() && sent[i].end != pos) i++;
+    if (i < sent.size() && equal(&record, &sent[i].record) && timestamp == sent[i].timestamp)
+    {
+      if (exact++ == 0) *firstExact = i;
+    }
+    else (*wrong)++;
+  }
+  return exact;
+}
+
+/* ================================== Main ================================== */
+int main()
+{
+  HM11_Uplink node;
+  std::vector<uint8_t> stream;
+  std::vector<sent_t> sent;
+  uint32_t ms = 123456;
+  for (uint16_t i = 0; i < RECORDS; i++)
+  {
+    sent_t s;
+    memset(&s.record, 0, sizeof(s.record));
+    uint8_t u = uint8_t(random(UUIDS));
+    memset(s.record.uuid, 0x10 + u, 16);
+    s.record.accessAddress = (u == 2) ? 0x4C000216 : 0x4C000215;
+    s.record.mac[5] = uint8_t(random(20));
+    s.record.major = uint16_t(random(65536));
+    s.record.minor = uint16_t(random(65536));
+    s.record.measuredPower = -59;
+    s.record.rssi = int8_t(-40 - random(60));
+    ms += uint32_t(random(400));
+    s.timestamp = ms;
+
+    uint8_t buffer[HM11_Uplink::MAX_RECORD_SIZE];
+    uint8_t length = node.encode(&s.record, s.timestamp, buffer);
+    CHECK(length <= HM11_Uplink::MAX_RECORD_SIZE);
+    stream.insert(stream.end(), buffer, buffer + length);
+    s.end = stream.size();
+    sent.push_back(s);
+  }
+  printf("%u records in %u bytes (%.1f per record)\n", RECORDS, unsigned(stream.size()), double(stream.size()) / RECORDS);
+
+  /* whole stream */
+  uint16_t wrong, first;
+  CHECK(receive(stream, 0, sent, &wrong, &first) == RECORDS);
+  CHECK(wrong == 0);
+
+  /* a flipped byte costs the records until the UUIDs and the time are relearned */
+  std::vector<uint8_t> corrupt = stream;
+  corrupt[sent[100].end - 5] ^= 0x01;
+  uint16_t exact = receive(corrupt, 0, sent, &wrong, &first);
+  CHECK(wrong == 0);
+  CHECK(exact >= RECORDS - 1 - UUIDS * HM11_Uplink::REFRESH_INTERVAL);
+  printf("corrupt record 100: %u of %u exact\n", exact, RECORDS);
+
+  /* late join in the middle of a record */
+  exact = receive(stream, sent[150].end - 7, sent, &wrong, &first);
+  CHECK(wrong == 0);
+  CHECK(first <= 151 + UUIDS * HM11_Uplink::REFRESH_INTERVAL);
+  CHECK(exact >= RECORDS - 151 - UUIDS * HM11_Uplink::REFRESH_INTERVAL);
+  printf("late join at record 151: first exact record %u, %u of %u exact\n", first, exact, RECORDS - 151);
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}